@@ -0,0 +1,152 @@
+'use strict';
+
+const { Duplex } = require('stream');
+const { inherits } = require('util');
+
+const defaultHighWaterMark = 1024 * 1024;
+const defaultMaxMessageSize = 65536;
+
+/**
+ * A Duplex stream over an RTCDataChannel. Writes wait while the
+ * RTCDataChannel's bufferedAmount is above the stream's highWaterMark, and
+ * reads pause the RTCDataChannel's native message delivery while the stream's
+ * buffer is full. While the stream is open, it owns the RTCDataChannel's
+ * bufferedAmountLowThreshold.
+ * @param {RTCDataChannel} channel
+ * @param {object} [options]
+ * @param {number} [options.highWaterMark=1048576]
+ * @param {number} [options.maxMessageSize=65536] - writes are split into
+ *   messages no larger than this
+ */
+function RTCDataChannelStream(channel, options) {
+  options = Object.assign({
+    highWaterMark: defaultHighWaterMark,
+    maxMessageSize: defaultMaxMessageSize
+  }, options);
+
+  Duplex.call(this, {
+    allowHalfOpen: false,
+    highWaterMark: options.highWaterMark
+  });
+
+  const self = this;
+
+  this._channel = channel;
+  this._highWaterMark = options.highWaterMark;
+  this._maxMessageSize = options.maxMessageSize;
+  this._onBufferedAmountLow = null;
+  this._onClose = null;
+
+  const bufferedAmountLowThreshold = channel.bufferedAmountLowThreshold;
+  channel.bufferedAmountLowThreshold = Math.floor(options.highWaterMark / 2);
+
+  function push(data) {
+    if (!self.destroyed && !self.push(Buffer.from(data))) {
+      channel._pause();
+    }
+  }
+
+  function onmessage({ data }) {
+    push(data);
+  }
+
+  function onmessages({ data }) {
+    data.forEach(push);
+  }
+
+  function onbufferedamountlow() {
+    const callback = self._onBufferedAmountLow;
+    self._onBufferedAmountLow = null;
+    if (callback) {
+      callback();
+    }
+  }
+
+  function onerror({ error }) {
+    self.destroy(error);
+  }
+
+  function onclose() {
+    self._detach();
+    const onClose = self._onClose;
+    self._onClose = null;
+    if (onClose) {
+      onClose();
+    }
+    onbufferedamountlow();
+    self.push(null);
+  }
+
+  this._detach = function detach() {
+    self._detach = function() {};
+    channel.removeEventListener('message', onmessage);
+    channel.removeEventListener('messages', onmessages);
+    channel.removeEventListener('bufferedamountlow', onbufferedamountlow);
+    channel.removeEventListener('error', onerror);
+    channel.removeEventListener('close', onclose);
+    channel.bufferedAmountLowThreshold = bufferedAmountLowThreshold;
+  };
+
+  channel.addEventListener('message', onmessage);
+  channel.addEventListener('messages', onmessages);
+  channel.addEventListener('bufferedamountlow', onbufferedamountlow);
+  channel.addEventListener('error', onerror);
+  channel.addEventListener('close', onclose);
+}
+
+inherits(RTCDataChannelStream, Duplex);
+
+RTCDataChannelStream.prototype._read = function _read() {
+  this._channel._resume();
+};
+
+RTCDataChannelStream.prototype._write = function _write(chunk, encoding, callback) {
+  const channel = this._channel;
+
+  if (channel.readyState === 'connecting') {
+    const self = this;
+    channel.addEventListener('open', function onopen() {
+      channel.removeEventListener('open', onopen);
+      self._write(chunk, encoding, callback);
+    });
+    return;
+  }
+
+  const messages = [];
+  for (let offset = 0; offset < chunk.length; offset += this._maxMessageSize) {
+    messages.push(chunk.subarray(offset, offset + this._maxMessageSize));
+  }
+
+  try {
+    if (channel.sendMany(messages) !== messages.length) {
+      throw new Error('RTCDataChannel did not accept every message');
+    }
+  } catch (error) {
+    callback(error);
+    return;
+  }
+
+  if (channel.bufferedAmount > this._highWaterMark) {
+    this._onBufferedAmountLow = callback;
+    return;
+  }
+  callback();
+};
+
+RTCDataChannelStream.prototype._final = function _final(callback) {
+  if (this._channel.readyState === 'closed') {
+    callback();
+    return;
+  }
+  this._onClose = callback;
+  this._channel.close();
+};
+
+RTCDataChannelStream.prototype._destroy = function _destroy(error, callback) {
+  this._detach();
+  this._channel._resume();
+  this._channel.close();
+  callback(error);
+};
+
+module.exports = RTCDataChannelStream;
@@ -16,14 +16,18 @@ const {
   RTCSctpTransport,
   RTCVideoSink,
   RTCVideoSource,
+  getEventLoopStats,
   getUserMedia,
   i420ToRgba,
   rgbaToI420,
-  setDOMException
+  setDOMException,
+  setEventLoopBudget
 } = require('./binding');
 
 const EventTarget = require('./eventtarget');
 const MediaDevices = require('./mediadevices');
+const nativeMetrics = require('./nativemetrics');
+const RTCDataChannelStream = require('./datachannelstream');
 
 inherits(MediaStream, EventTarget);
 inherits(MediaStreamTrack, EventTarget);
@@ -40,24 +44,49 @@ try {
   // Do nothing
 }
 
+// NOTE: SendBuffers are recognized here, by mapping each one to its
+// native owner, so that sending an ArrayBuffer never takes a native lock.
+const sendBufferOwners = new WeakMap();
+
+function getSendBufferOwner(data) {
+  return sendBufferOwners.get(ArrayBuffer.isView(data) ? data.buffer : data);
+}
+
+RTCDataChannel.prototype.createSendBuffer = function createSendBuffer(byteLength) {
+  const [buffer, owner] = this._createSendBuffer(byteLength);
+  sendBufferOwners.set(buffer, owner);
+  return buffer;
+};
+
 // NOTE(mroberts): Here's a hack to support jsdom's Blob implementation.
 RTCDataChannel.prototype.send = function send(data) {
   const implSymbol = Object.getOwnPropertySymbols(data).find(symbol => symbol.toString() === 'Symbol(impl)');
   if (data[implSymbol] && data[implSymbol]._buffer) {
     data = data[implSymbol]._buffer;
   }
-  this._send(data);
+  this._send(data, getSendBufferOwner(data));
+};
+
+RTCDataChannel.prototype.sendMany = function sendMany(messages) {
+  return this._sendMany(messages, Array.isArray(messages) ? messages.map(getSendBufferOwner) : undefined);
+};
+
+RTCDataChannel.prototype.createStream = function createStream(options) {
+  return new RTCDataChannelStream(this, options);
 };
 
 const mediaDevices = new MediaDevices();
 
 const nonstandard = {
+  getEventLoopStats,
   i420ToRgba,
+  nativeMetrics,
   RTCAudioSink,
   RTCAudioSource,
   RTCVideoSink,
   RTCVideoSource,
-  rgbaToI420
+  rgbaToI420,
+  setEventLoopBudget
 };
 
 module.exports = {
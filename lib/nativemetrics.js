@@ -0,0 +1,65 @@
+'use strict';
+
+const { getEventLoopStats, getEventMetrics } = require('./binding');
+
+/**
+ * Convert native metrics to Node's trace_events format (that is, Chrome's
+ * Trace Event Format), as counter events.
+ */
+function toTraceEvents(metrics) {
+  const [seconds, nanoseconds] = process.hrtime();
+  const ts = seconds * 1e6 + Math.floor(nanoseconds / 1e3);
+  const pid = process.pid;
+  const traceEvents = [{
+    name: 'wrtc.eventLoop',
+    cat: 'node-webrtc',
+    ph: 'C',
+    ts,
+    pid,
+    tid: 0,
+    args: {
+      wakeups: metrics.wakeups,
+      eventsDispatched: metrics.eventsDispatched,
+      eventsPerWakeup: metrics.eventsPerWakeup
+    }
+  }];
+  Object.keys(metrics.classes).forEach(name => {
+    const { eventsEnqueued, eventsDispatched, queueDepth, wakeups } = metrics.classes[name];
+    traceEvents.push({
+      name: `wrtc.${name}`,
+      cat: 'node-webrtc',
+      ph: 'C',
+      ts,
+      pid,
+      tid: 0,
+      args: { eventsEnqueued, eventsDispatched, queueDepth, wakeups }
+    });
+  });
+  return { traceEvents };
+}
+
+/**
+ * Report counters for the native event pipeline, process-wide and per class.
+ * Pass { format: 'traceEvents' } to get them as trace_events counter events.
+ */
+function nativeMetrics(options = {}) {
+  const stats = getEventLoopStats();
+  const metrics = {
+    wakeups: stats.wakeups,
+    eventsDispatched: stats.eventsDispatched,
+    eventsPerWakeup: stats.wakeups ? stats.eventsDispatched / stats.wakeups : 0,
+    maxEventsPerWakeup: stats.maxEventsPerWakeup,
+    budgetExhausted: stats.budgetExhausted,
+    preemptions: stats.preemptions,
+    eventAllocations: stats.eventAllocations,
+    classes: getEventMetrics()
+  };
+  if (options.format === 'traceEvents') {
+    return toTraceEvents(metrics);
+  } else if (options.format !== undefined) {
+    throw new TypeError(`Unsupported format "${options.format}"`);
+  }
+  return metrics;
+}
+
+module.exports = nativeMetrics;
@@ -58,11 +58,13 @@ function RTCPeerConnection() {
     self.dispatchEvent({ type: 'iceconnectionstatechange', target: self });
   };
 
-  pc.onicegatheringstatechange = function onicegatheringstatechange() {
+  // NOTE: State changes are coalesced natively, and each handler
+  // receives the new state.
+  pc.onicegatheringstatechange = function onicegatheringstatechange(state) {
     self.dispatchEvent({ type: 'icegatheringstatechange', target: self });
 
     // if we have completed gathering candidates, trigger a null candidate event
-    if (self.iceGatheringState === 'complete' && self.connectionState !== 'closed') {
+    if (state === 'complete' && self.connectionState !== 'closed') {
       self.dispatchEvent(new RTCPeerConnectionIceEvent('icecandidate', { candidate: null, target: self }));
     }
   };
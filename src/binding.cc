@@ -31,6 +31,8 @@
 #include "src/methods/i420_helpers.h"
 #include "src/node/async_context_releaser.h"
 #include "src/node/error_factory.h"
+#include "src/node/event_dispatcher.h"
+#include "src/node/event_metrics.h"
 
 #ifdef DEBUG
 #include "src/test.h"
@@ -43,6 +45,8 @@ static void dispose(void*) {
 static Napi::Object Init(Napi::Env env, Napi::Object exports) {
   node_webrtc::AsyncContextReleaser::Init(env, exports);
   node_webrtc::ErrorFactory::Init(env, exports);
+  node_webrtc::EventDispatcher::Init(env, exports);
+  node_webrtc::EventMetrics::Init(env, exports);
   node_webrtc::GetDisplayMedia::Init(env, exports);
   node_webrtc::GetUserMedia::Init(env, exports);
   node_webrtc::I420Helpers::Init(env, exports);
@@ -0,0 +1,19 @@
+#include "src/dictionaries/node_webrtc/event_queue_limit.h"
+
+#include "src/functional/validation.h"
+
+namespace node_webrtc {
+
+#define EVENT_QUEUE_LIMIT_FN CreateEventQueueLimit
+
+static Validation<EVENT_QUEUE_LIMIT> EVENT_QUEUE_LIMIT_FN(
+    const uint32_t capacity,
+    const OverflowPolicy policy) {
+  return Pure<EVENT_QUEUE_LIMIT>({capacity, policy});
+}
+
+}  // namespace node_webrtc
+
+#define DICT(X) EVENT_QUEUE_LIMIT ## X
+#include "src/dictionaries/macros/impls.h"
+#undef DICT
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+#include "src/enums/node_webrtc/overflow_policy.h"
+
+// IWYU pragma: no_forward_declare node_webrtc::EventQueueLimit
+// IWYU pragma: no_include "src/dictionaries/macros/impls.h"
+
+#define EVENT_QUEUE_LIMIT EventQueueLimit
+#define EVENT_QUEUE_LIMIT_LIST \
+  DICT_DEFAULT(uint32_t, capacity, "capacity", 0) \
+  DICT_DEFAULT(OverflowPolicy, policy, "policy", OverflowPolicy::kDropOldest)
+
+#define DICT(X) EVENT_QUEUE_LIMIT ## X
+#include "src/dictionaries/macros/def.h"
+#include "src/dictionaries/macros/decls.h"
+#undef DICT
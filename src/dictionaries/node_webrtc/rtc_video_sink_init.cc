@@ -0,0 +1,35 @@
+#include "src/dictionaries/node_webrtc/rtc_video_sink_init.h"
+
+#include <cmath>
+
+#include "src/functional/maybe.h"
+#include "src/functional/validation.h"
+
+namespace node_webrtc {
+
+#define RTC_VIDEO_SINK_INIT_FN CreateRTCVideoSinkInit
+
+static Validation<RTC_VIDEO_SINK_INIT> RTC_VIDEO_SINK_INIT_FN(
+    const bool zeroCopy,
+    const RTCVideoFrameFormat format,
+    const Maybe<uint32_t> width,
+    const Maybe<uint32_t> height,
+    const bool latestFrameOnly,
+    const Maybe<double> maxFramesPerSecond,
+    const bool dispatchFrames) {
+  // NOTE: 16384 is well beyond anything libwebrtc will decode, and
+  // keeps every plane size comfortably within an int.
+  auto isValid = [](uint32_t dimension) { return dimension > 0 && dimension <= 16384; };
+  if (!width.Map(isValid).FromMaybe(true) || !height.Map(isValid).FromMaybe(true)) {
+    return Validation<RTC_VIDEO_SINK_INIT>::Invalid("Expected width and height to be between 1 and 16384");
+  } else if (!maxFramesPerSecond.Map([](double fps) { return std::isfinite(fps) && fps > 0; }).FromMaybe(true)) {
+    return Validation<RTC_VIDEO_SINK_INIT>::Invalid("Expected maxFramesPerSecond to be a positive number");
+  }
+  return Pure<RTC_VIDEO_SINK_INIT>({zeroCopy, format, width, height, latestFrameOnly, maxFramesPerSecond, dispatchFrames});
+}
+
+}  // namespace node_webrtc
+
+#define DICT(X) RTC_VIDEO_SINK_INIT ## X
+#include "src/dictionaries/macros/impls.h"
+#undef DICT
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+#include "src/enums/node_webrtc/rtc_video_frame_format.h"
+
+// IWYU pragma: no_forward_declare node_webrtc::RTCVideoSinkInit
+// IWYU pragma: no_include "src/dictionaries/macros/impls.h"
+
+#define RTC_VIDEO_SINK_INIT RTCVideoSinkInit
+#define RTC_VIDEO_SINK_INIT_LIST \
+  DICT_DEFAULT(bool, zeroCopy, "zeroCopy", false) \
+  DICT_DEFAULT(RTCVideoFrameFormat, format, "format", RTCVideoFrameFormat::kI420) \
+  DICT_OPTIONAL(uint32_t, width, "width") \
+  DICT_OPTIONAL(uint32_t, height, "height") \
+  DICT_DEFAULT(bool, latestFrameOnly, "latestFrameOnly", false) \
+  DICT_OPTIONAL(double, maxFramesPerSecond, "maxFramesPerSecond") \
+  DICT_DEFAULT(bool, dispatchFrames, "dispatchFrames", true)
+
+#define DICT(X) RTC_VIDEO_SINK_INIT ## X
+#include "src/dictionaries/macros/def.h"
+#include "src/dictionaries/macros/decls.h"
+#undef DICT
@@ -0,0 +1,62 @@
+#include "src/dictionaries/node_webrtc/rtc_video_sink_wants.h"
+
+#include <limits>
+
+#include <node-addon-api/napi.h>
+#include <webrtc/api/video/video_source_interface.h>
+
+#include "src/functional/maybe.h"
+#include "src/functional/validation.h"
+
+namespace node_webrtc {
+
+#define RTC_VIDEO_SINK_WANTS_FN CreateRTCVideoSinkWants
+
+static Validation<RTC_VIDEO_SINK_WANTS> RTC_VIDEO_SINK_WANTS_FN(
+    const Maybe<uint32_t> maxPixelCount,
+    const Maybe<uint32_t> targetPixelCount,
+    const Maybe<uint32_t> maxFramerate,
+    const bool rotationApplied,
+    const uint32_t resolutionAlignment) {
+  // NOTE: rtc::VideoSinkWants stores these as ints.
+  auto fitsInInt = [](uint32_t value) { return value <= static_cast<uint32_t>(std::numeric_limits<int>::max()); };
+  if (!maxPixelCount.Map(fitsInInt).FromMaybe(true)
+      || !targetPixelCount.Map(fitsInInt).FromMaybe(true)
+      || !maxFramerate.Map(fitsInInt).FromMaybe(true)
+      || !fitsInInt(resolutionAlignment)) {
+    return Validation<RTC_VIDEO_SINK_WANTS>::Invalid("Expected maxPixelCount, targetPixelCount, maxFramerate and resolutionAlignment to fit in a signed 32-bit integer");
+  } else if (!resolutionAlignment) {
+    return Validation<RTC_VIDEO_SINK_WANTS>::Invalid("Expected resolutionAlignment to be at least 1");
+  } else if (maxPixelCount.IsJust() && targetPixelCount.IsJust()
+      && targetPixelCount.UnsafeFromJust() > maxPixelCount.UnsafeFromJust()) {
+    return Validation<RTC_VIDEO_SINK_WANTS>::Invalid("Expected targetPixelCount to be at most maxPixelCount");
+  }
+  return Pure<RTC_VIDEO_SINK_WANTS>({maxPixelCount, targetPixelCount, maxFramerate, rotationApplied, resolutionAlignment});
+}
+
+CONVERTER_IMPL(RTCVideoSinkWants, rtc::VideoSinkWants, init) {
+  rtc::VideoSinkWants wants;
+  wants.rotation_applied = init.rotationApplied;
+  wants.resolution_alignment = static_cast<int>(init.resolutionAlignment);
+  if (init.maxPixelCount.IsJust()) {
+    wants.max_pixel_count = static_cast<int>(init.maxPixelCount.UnsafeFromJust());
+  }
+  if (init.targetPixelCount.IsJust()) {
+    wants.target_pixel_count = static_cast<int>(init.targetPixelCount.UnsafeFromJust());
+  }
+  if (init.maxFramerate.IsJust()) {
+    wants.max_framerate_fps = static_cast<int>(init.maxFramerate.UnsafeFromJust());
+  }
+  return Pure(wants);
+}
+
+FROM_NAPI_IMPL(rtc::VideoSinkWants, value) {
+  return From<RTCVideoSinkWants>(value)
+      .FlatMap<rtc::VideoSinkWants>(Converter<RTCVideoSinkWants, rtc::VideoSinkWants>::Convert);
+}
+
+}  // namespace node_webrtc
+
+#define DICT(X) RTC_VIDEO_SINK_WANTS ## X
+#include "src/dictionaries/macros/impls.h"
+#undef DICT
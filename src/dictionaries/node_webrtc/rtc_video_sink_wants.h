@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+#include "src/converters.h"
+
+namespace rtc { struct VideoSinkWants; }
+
+// IWYU pragma: no_forward_declare node_webrtc::RTCVideoSinkWants
+// IWYU pragma: no_include "src/dictionaries/macros/impls.h"
+
+#define RTC_VIDEO_SINK_WANTS RTCVideoSinkWants
+#define RTC_VIDEO_SINK_WANTS_LIST \
+  DICT_OPTIONAL(uint32_t, maxPixelCount, "maxPixelCount") \
+  DICT_OPTIONAL(uint32_t, targetPixelCount, "targetPixelCount") \
+  DICT_OPTIONAL(uint32_t, maxFramerate, "maxFramerate") \
+  DICT_DEFAULT(bool, rotationApplied, "rotationApplied", false) \
+  DICT_DEFAULT(uint32_t, resolutionAlignment, "resolutionAlignment", 1)
+
+#define DICT(X) RTC_VIDEO_SINK_WANTS ## X
+#include "src/dictionaries/macros/def.h"
+#include "src/dictionaries/macros/decls.h"
+#undef DICT
+
+namespace node_webrtc {
+
+DECLARE_CONVERTER(RTCVideoSinkWants, rtc::VideoSinkWants)
+
+DECLARE_FROM_NAPI(rtc::VideoSinkWants)
+
+}  // namespace node_webrtc
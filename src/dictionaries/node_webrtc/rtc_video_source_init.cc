@@ -9,8 +9,9 @@ namespace node_webrtc {
 
 static Validation<RTC_VIDEO_SOURCE_INIT> RTC_VIDEO_SOURCE_INIT_FN(
     const bool isScreencast,
-    const Maybe<bool> needsDenoising) {
-  return Pure<RTC_VIDEO_SOURCE_INIT>({isScreencast, needsDenoising});
+    const Maybe<bool> needsDenoising,
+    const bool adaptFrames) {
+  return Pure<RTC_VIDEO_SOURCE_INIT>({isScreencast, needsDenoising, adaptFrames});
 }
 
 }  // namespace node_webrtc
@@ -0,0 +1,5 @@
+#include "src/enums/node_webrtc/overflow_policy.h"
+
+#define ENUM(X) OVERFLOW_POLICY ## X
+#include "src/enums/macros/impls.h"
+#undef ENUM
@@ -0,0 +1,16 @@
+#pragma once
+
+// IWYU pragma: no_include "src/enums/macros/impls.h"
+
+#define OVERFLOW_POLICY OverflowPolicy
+#define OVERFLOW_POLICY_NAME "OverflowPolicy"
+#define OVERFLOW_POLICY_LIST \
+  ENUM_SUPPORTED(kDropOldest, "drop-oldest") \
+  ENUM_SUPPORTED(kDropNewest, "drop-newest") \
+  ENUM_SUPPORTED(kBlock, "block") \
+  ENUM_SUPPORTED(kCoalesce, "coalesce")
+
+#define ENUM(X) OVERFLOW_POLICY ## X
+#include "src/enums/macros/def.h"
+#include "src/enums/macros/decls.h"
+#undef ENUM
@@ -0,0 +1,5 @@
+#include "src/enums/node_webrtc/rtc_video_frame_format.h"
+
+#define ENUM(X) RTC_VIDEO_FRAME_FORMAT ## X
+#include "src/enums/macros/impls.h"
+#undef ENUM
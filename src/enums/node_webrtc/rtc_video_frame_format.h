@@ -0,0 +1,15 @@
+#pragma once
+
+// IWYU pragma: no_include "src/enums/macros/impls.h"
+
+#define RTC_VIDEO_FRAME_FORMAT RTCVideoFrameFormat
+#define RTC_VIDEO_FRAME_FORMAT_NAME "RTCVideoFrameFormat"
+#define RTC_VIDEO_FRAME_FORMAT_LIST \
+  ENUM_SUPPORTED(kI420, "i420") \
+  ENUM_SUPPORTED(kNv12, "nv12") \
+  ENUM_SUPPORTED(kRgba, "rgba")
+
+#define ENUM(X) RTC_VIDEO_FRAME_FORMAT ## X
+#include "src/enums/macros/def.h"
+#include "src/enums/macros/decls.h"
+#undef ENUM
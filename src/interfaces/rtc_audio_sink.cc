@@ -50,12 +50,14 @@ Napi::Value RTCAudioSink::GetStopped(const Napi::CallbackInfo& info) {
 }
 
 void RTCAudioSink::Stop() {
+  // NOTE: Stop the EventLoop first, so that a callback blocked on a
+  // full queue gives up instead of holding RemoveSink up.
+  AsyncObjectWrapWithLoop<RTCAudioSink>::Stop();
   if (_track) {
     _stopped = true;
     _track->RemoveSink(this);
     _track = nullptr;
   }
-  AsyncObjectWrapWithLoop<RTCAudioSink>::Stop();
 }
 
 Napi::Value RTCAudioSink::JsStop(const Napi::CallbackInfo& info) {
@@ -77,7 +79,7 @@ void RTCAudioSink::OnData(
   }
   memcpy(audio_data_copy.get(), audio_data, byte_length);
 
-  Dispatch(CreateCallback<RTCAudioSink>([
+  DispatchBounded(CreateCallback<RTCAudioSink>([
              this,
              audio_data_copy = std::move(audio_data_copy),
              bits_per_sample,
@@ -110,7 +112,10 @@ void RTCAudioSink::OnData(
 
 void RTCAudioSink::Init(Napi::Env env, Napi::Object exports) {
   auto func = DefineClass(env, "RTCAudioSink", {
+    CallbackProperty("dispatchEvent"),
+    InstanceAccessor("droppedEvents", &RTCAudioSink::GetDroppedEvents, nullptr),
     InstanceAccessor("stopped", &RTCAudioSink::GetStopped, nullptr),
+    InstanceMethod("setQueueLimit", &RTCAudioSink::JsSetQueueLimit),
     InstanceMethod("stop", &RTCAudioSink::JsStop)
   });
 
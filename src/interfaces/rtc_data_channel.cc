@@ -7,13 +7,24 @@
  */
 #include "src/interfaces/rtc_data_channel.h"
 
+#include <cstring>
+#include <limits>
+#include <mutex>
 #include <utility>
+#include <vector>
 
 #include <webrtc/api/data_channel_interface.h>
 #include <webrtc/api/scoped_refptr.h>
 #include <webrtc/rtc_base/copy_on_write_buffer.h>
+#include <webrtc/rtc_base/location.h>
+#include <webrtc/rtc_base/ref_counted_object.h>
+#include <webrtc/rtc_base/thread.h>
+#include <webrtc/rtc_base/time_utils.h>
 
+#include "src/converters/arguments.h"
+#include "src/dictionaries/node_webrtc/event_queue_limit.h"
 #include "src/enums/node_webrtc/binary_type.h"
+#include "src/enums/node_webrtc/overflow_policy.h"
 #include "src/enums/webrtc/data_state.h"
 #include "src/interfaces/rtc_peer_connection/peer_connection_factory.h"
 #include "src/node/error_factory.h"
@@ -48,14 +59,16 @@ void DataChannelObserver::OnStateChange() {
 }
 
 void DataChannelObserver::OnMessage(const webrtc::DataBuffer& buffer) {
-  Enqueue(Callback1<RTCDataChannel>::Create([buffer](RTCDataChannel & channel) {
-    RTCDataChannel::HandleMessage(channel, buffer);
+  // NOTE: Copying a DataBuffer only adds a reference to its underlying
+  // rtc::CopyOnWriteBuffer; the bytes themselves are not copied.
+  Enqueue(Callback1<RTCDataChannel>::Create([buffer](RTCDataChannel & channel) mutable {
+    RTCDataChannel::HandleMessage(channel, std::move(buffer));
   }));
 }
 
 static void requeue(DataChannelObserver& observer, RTCDataChannel& channel) {
   while (auto event = observer.Dequeue()) {
-    channel.Dispatch(std::move(event));
+    channel.Dispatch(std::move(event), EventPriority::kBulk);
   }
 }
 
@@ -75,23 +88,36 @@ RTCDataChannel::RTCDataChannel(const Napi::CallbackInfo& info)
   _factory->Ref();
 
   _jingleDataChannel = observer->_jingleDataChannel;
-  _jingleDataChannel->RegisterObserver(this);
+
+  // NOTE: Every call through _jingleDataChannel blocks on the
+  // signaling thread, so we read its properties in one hop here and serve the
+  // getters from this snapshot. OnStateChange keeps the mutable ones current.
+  _factory->_signalingThread->Invoke<void>(RTC_FROM_HERE, [this]() {
+    _jingleDataChannel->RegisterObserver(this);
+    _cached_id = _jingleDataChannel->id();
+    _cached_label = _jingleDataChannel->label();
+    _cached_max_packet_life_time = _jingleDataChannel->maxRetransmitTime();
+    _cached_max_retransmits = _jingleDataChannel->maxRetransmits();
+    _cached_negotiated = _jingleDataChannel->negotiated();
+    _cached_ordered = _jingleDataChannel->ordered();
+    _cached_protocol = _jingleDataChannel->protocol();
+    _cached_ready_state = _jingleDataChannel->state();
+  });
 
   // Re-queue cached observer events
   requeue(*observer, *this);
 
   delete observer;
-
-  // NOTE(mroberts): These doesn't actually matter yet.
-  _cached_id = 0;
-  _cached_max_packet_life_time = 0;
-  _cached_max_retransmits = 0;
-  _cached_negotiated = false;
-  _cached_ordered = false;
-  _cached_buffered_amount = 0;
 }
 
 RTCDataChannel::~RTCDataChannel() {
+  _factory->_signalingThread->Invoke<void>(RTC_FROM_HERE, [this]() {
+    if (_bridge) {
+      _bridge->Stop();
+      _bridge = nullptr;
+    }
+  });
+
   _factory->Unref();
   _factory = nullptr;
 
@@ -103,14 +129,7 @@ void RTCDataChannel::CleanupInternals() {
     return;
   }
   _jingleDataChannel->UnregisterObserver();
-  _cached_id = _jingleDataChannel->id();
-  _cached_label = _jingleDataChannel->label();
-  _cached_max_packet_life_time = _jingleDataChannel->maxRetransmitTime();
-  _cached_max_retransmits = _jingleDataChannel->maxRetransmits();
-  _cached_negotiated = _jingleDataChannel->negotiated();
-  _cached_ordered = _jingleDataChannel->ordered();
-  _cached_protocol = _jingleDataChannel->protocol();
-  _cached_buffered_amount = _jingleDataChannel->buffered_amount();
+  _cached_ready_state = webrtc::DataChannelInterface::kClosed;
   _jingleDataChannel = nullptr;
 }
 
@@ -121,13 +140,23 @@ void RTCDataChannel::OnPeerConnectionClosed() {
 }
 
 void RTCDataChannel::OnStateChange() {
+  // NOTE: This runs on the signaling thread, so these calls do not
+  // block. The id of a channel which was not negotiated is assigned once the
+  // SCTP transport is ready.
   auto state = _jingleDataChannel->state();
+  _cached_id = _jingleDataChannel->id();
+  _cached_ready_state = state;
   if (state == webrtc::DataChannelInterface::kClosed) {
+    StopBridge();
     CleanupInternals();
+    // NOTE: Deliver any paused messages before "close".
+    ResumeMessages();
   }
+  // NOTE: Every RTCDataChannel event, state changes included, goes in
+  // the bulk lane, so that "close" never overtakes a message.
   Dispatch(CreateCallback<RTCDataChannel>([this, state]() {
     RTCDataChannel::HandleStateChange(*this, state);
-  }));
+  }), EventPriority::kBulk);
 }
 
 void RTCDataChannel::HandleStateChange(RTCDataChannel& channel, webrtc::DataChannelInterface::DataState state) {
@@ -141,82 +170,306 @@ void RTCDataChannel::HandleStateChange(RTCDataChannel& channel, webrtc::DataChan
   }
   channel.MakeCallback("dispatchEvent", { object });
   if (state == webrtc::DataChannelInterface::kClosed) {
+    channel.ReleaseSendBuffers(true);
     channel.Stop();
   }
 }
 
 void RTCDataChannel::OnMessage(const webrtc::DataBuffer& buffer) {
-  Dispatch(CreateCallback<RTCDataChannel>([this, buffer]() {
-    RTCDataChannel::HandleMessage(*this, buffer);
+  _messages_received.fetch_add(1, std::memory_order_relaxed);
+  _bytes_received.fetch_add(buffer.size(), std::memory_order_relaxed);
+  if (_bridge) {
+    _bridge->OnMessage(buffer);
+    return;
+  }
+  bool overflowed = false;
+  {
+    std::lock_guard<std::mutex> lock(_message_mutex);
+    if (!_paused) {
+      DispatchMessage(buffer);
+      return;
+    }
+    // NOTE: libwebrtc has no receive-side flow control, so past
+    // kMaxPausedBytes we fail the RTCDataChannel rather than hold messages
+    // without limit or silently lose some. The first message is always held,
+    // however large.
+    if (_paused_overflowed || (!_paused_messages.empty() && _paused_bytes + buffer.size() > kMaxPausedBytes)) {
+      DidDropEvent();
+      overflowed = !_paused_overflowed;
+      _paused_overflowed = true;
+    } else {
+      _paused_messages.push_back(buffer);
+      _paused_bytes += buffer.size();
+    }
+  }
+  if (!overflowed) {
+    return;
+  }
+  Dispatch(CreateCallback<RTCDataChannel>([this]() {
+    auto env = Env();
+    Napi::HandleScope scope(env);
+    auto object = Napi::Object::New(env);
+    object.Set("type", Napi::String::New(env, "error"));
+    object.Set("error", Napi::Error::New(env, "RTCDataChannel received too many messages while paused").Value());
+    MakeCallback("dispatchEvent", { object });
+  }), EventPriority::kBulk);
+  // NOTE: Close outside of _message_mutex, since closing resumes messages.
+  if (_jingleDataChannel) {
+    _jingleDataChannel->Close();
+  }
+}
+
+void RTCDataChannel::DispatchMessage(const webrtc::DataBuffer& buffer) {
+  // NOTE: Once a batch has started, keep appending to it (even if
+  // batching was just disabled) so that messages are delivered in order.
+  auto enqueued_at = rtc::TimeMicros();
+  if (_batch_messages || !_batch.empty()) {
+    // NOTE: A batch is a single Event, so the queue limit bounds the
+    // messages waiting in it instead.
+    auto first = _batch.empty();
+    OverflowPolicy policy;
+    auto limit = queue_limit(&policy);
+    if (limit && _batch.size() >= limit) {
+      DidDropEvent();
+      if (policy == OverflowPolicy::kDropNewest) {
+        return;
+      }
+      _batch.erase(_batch.begin());
+    }
+    _batch.push_back(buffer);
+    if (first) {
+      Dispatch(CreateCallback<RTCDataChannel>([this, enqueued_at]() {
+        _dispatch_latency.Record(rtc::TimeMicros() - enqueued_at);
+        RTCDataChannel::HandleMessages(*this);
+      }), EventPriority::kBulk);
+    }
+    return;
+  }
+  DispatchBounded(CreateCallback<RTCDataChannel>([this, buffer, enqueued_at]() mutable {
+    _dispatch_latency.Record(rtc::TimeMicros() - enqueued_at);
+    RTCDataChannel::HandleMessage(*this, std::move(buffer));
   }));
 }
 
-void RTCDataChannel::HandleMessage(RTCDataChannel& channel, const webrtc::DataBuffer& buffer) {
-  bool binary = buffer.binary;
-  size_t size = buffer.size();
+void RTCDataChannel::ResumeMessages() {
+  std::lock_guard<std::mutex> lock(_message_mutex);
+  _paused = false;
+  for (auto const& buffer : _paused_messages) {
+    DispatchMessage(buffer);
+  }
+  _paused_messages.clear();
+  _paused_bytes = 0;
+}
+
+/**
+ * Create an ArrayBuffer which views the storage of an rtc::CopyOnWriteBuffer
+ * directly. The ArrayBuffer holds a reference to the storage until it is
+ * garbage collected.
+ */
+static Napi::ArrayBuffer CreateExternalArrayBuffer(Napi::Env env, rtc::CopyOnWriteBuffer&& data) {
+  auto size = data.size();
+  if (!size) {
+    return Napi::ArrayBuffer::New(env, 0);
+  }
+  auto owner = new rtc::CopyOnWriteBuffer(std::move(data));
+  // NOTE: By the time we get here, `owner` is usually the only
+  // reference to the storage, so asking for mutable data does not clone it.
+  auto bytes = owner->data();
+  return Napi::ArrayBuffer::New(env, bytes, size, [](Napi::Env, void*, rtc::CopyOnWriteBuffer* owner) {
+    delete owner;
+  }, owner);
+}
+
+static bool IsAscii(const uint8_t* bytes, size_t size) {
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, bytes + i, sizeof(word));
+    if (word & 0x8080808080808080ULL) {
+      return false;
+    }
+  }
+  for (; i < size; i++) {
+    if (bytes[i] & 0x80) {
+      return false;
+    }
+  }
+  return true;
+}
 
+/**
+ * Create a string from the UTF-8 contents of an rtc::CopyOnWriteBuffer. ASCII
+ * contents are created as a one-byte string, which skips UTF-8 decoding.
+ */
+static Napi::Value CreateString(Napi::Env env, const rtc::CopyOnWriteBuffer& data) {
+  auto bytes = data.cdata();
+  auto size = data.size();
+  napi_value string;
+  auto status = IsAscii(bytes, size)
+      ? napi_create_string_latin1(env, reinterpret_cast<const char*>(bytes), size, &string)  // NOLINT
+      : napi_create_string_utf8(env, reinterpret_cast<const char*>(bytes), size, &string);  // NOLINT
+  {
+    using Napi::Error;
+    NAPI_THROW_IF_FAILED(env, status, env.Undefined());
+  }
+  return Napi::Value(env, string);
+}
+
+static Napi::Value CreateMessageData(Napi::Env env, webrtc::DataBuffer&& buffer) {
+  if (buffer.binary) {
+    return CreateExternalArrayBuffer(env, std::move(buffer.data));
+  }
+  return CreateString(env, buffer.data);
+}
+
+void RTCDataChannel::HandleMessage(RTCDataChannel& channel, webrtc::DataBuffer&& buffer) {
   auto env = channel.Env();
   Napi::HandleScope scope(env);
-  Napi::Value value;
-  if (binary) {
-    char* message = new char[size];
-    memcpy(reinterpret_cast<void*>(message), reinterpret_cast<const void*>(buffer.data.data()), size);
-    auto array = Napi::ArrayBuffer::New(env, message, size, [](Napi::Env, void* buffer) {
-      delete[] static_cast<char*>(buffer);
-    });
-    value = array;  // NOLINT
-  } else {
-    auto str = Napi::String::New(env, reinterpret_cast<const char*>(buffer.data.data()), size);  // NOLINT
-    value = str;
+  auto object = Napi::Object::New(env);
+  object.Set("type", Napi::String::New(env, "message"));
+  object.Set("data", CreateMessageData(env, std::move(buffer)));
+  channel.MakeCallback("dispatchEvent", { object });
+}
+
+void RTCDataChannel::HandleMessages(RTCDataChannel& channel) {
+  std::vector<webrtc::DataBuffer> batch;
+  {
+    std::lock_guard<std::mutex> lock(channel._message_mutex);
+    batch.swap(channel._batch);
+  }
+  auto env = channel.Env();
+  Napi::HandleScope scope(env);
+  auto messages = Napi::Array::New(env, batch.size());
+  for (uint32_t i = 0; i < batch.size(); i++) {
+    messages.Set(i, CreateMessageData(env, std::move(batch[i])));
   }
   auto object = Napi::Object::New(env);
-  object.Set("type", "message");
-  object.Set("data", value);
+  object.Set("type", Napi::String::New(env, "messages"));
+  object.Set("data", messages);
   channel.MakeCallback("dispatchEvent", { object });
 }
 
+/**
+ * SendBuffers are ArrayBuffers whose storage is owned by an
+ * rtc::CopyOnWriteBuffer. Sending one shares its storage with libwebrtc instead
+ * of copying it. lib/index.js keeps each SendBuffer's owner, as an External, in
+ * a WeakMap and passes it back when sending, so recognizing a SendBuffer needs
+ * no lock or lookup here. The ArrayBuffer's finalizer deletes the owner; by
+ * then, the WeakMap entry holding the External is unreachable too.
+ */
+static Napi::Value NewSendBuffer(Napi::Env env, size_t size) {
+  auto owner = new rtc::CopyOnWriteBuffer(size, size);
+  auto arrayBuffer = Napi::ArrayBuffer::New(env, owner->data(), size, [](Napi::Env, void*, rtc::CopyOnWriteBuffer* owner) {
+    delete owner;
+  }, owner);
+  auto result = Napi::Array::New(env, 2);
+  result.Set(0u, arrayBuffer);
+  result.Set(1u, Napi::External<rtc::CopyOnWriteBuffer>::New(env, owner));
+  return result;
+}
+
+/**
+ * Encode a string as UTF-8 directly into the storage of a DataBuffer. If the
+ * string cannot be encoded, this throws and returns nullptr.
+ */
+static std::unique_ptr<webrtc::DataBuffer> CreateStringDataBuffer(const Napi::String& string) {
+  auto env = string.Env();
+  size_t length = 0;
+  auto status = napi_get_value_string_utf8(env, string, nullptr, 0, &length);
+  {
+    using Napi::Error;
+    NAPI_THROW_IF_FAILED(env, status, nullptr);
+  }
+  // NOTE: napi_get_value_string_utf8 always writes a null terminator,
+  // so we reserve room for it and then exclude it from the size.
+  rtc::CopyOnWriteBuffer data(length, length + 1);
+  status = napi_get_value_string_utf8(env, string, reinterpret_cast<char*>(data.data()), length + 1, &length);  // NOLINT
+  {
+    using Napi::Error;
+    NAPI_THROW_IF_FAILED(env, status, nullptr);
+  }
+  data.SetSize(length);
+  return std::unique_ptr<webrtc::DataBuffer>(new webrtc::DataBuffer(data, false));
+}
+
+/**
+ * Convert a value passed to `send` into a DataBuffer. If the value cannot be
+ * sent, this throws and returns nullptr. `maybeOwner` is the SendBuffer owner
+ * lib/index.js found for the value, if any. If the value is a SendBuffer sent
+ * in its entirety, `sendBuffer` is set to it.
+ */
+static std::unique_ptr<webrtc::DataBuffer> CreateDataBuffer(
+    const Napi::Value& value,
+    const Napi::Value& maybeOwner,
+    Napi::ArrayBuffer* sendBuffer) {
+  auto env = value.Env();
+  if (value.IsString()) {
+    return CreateStringDataBuffer(value.As<Napi::String>());
+  }
+
+  Napi::ArrayBuffer arraybuffer;
+  size_t byte_offset = 0;
+  size_t byte_length = 0;
+
+  if (value.IsTypedArray()) {
+    auto typedArray = value.As<Napi::TypedArray>();
+    arraybuffer = typedArray.ArrayBuffer();
+    byte_offset = typedArray.ByteOffset();
+    byte_length = typedArray.ByteLength();
+  } else if (value.IsDataView()) {
+    auto dataView = value.As<Napi::DataView>();
+    arraybuffer = dataView.ArrayBuffer();
+    byte_offset = dataView.ByteOffset();
+    byte_length = dataView.ByteLength();
+  } else if (value.IsArrayBuffer()) {
+    arraybuffer = value.As<Napi::ArrayBuffer>();
+    byte_length = arraybuffer.ByteLength();
+  } else {
+    Napi::TypeError::New(env, "Expected a Blob or ArrayBuffer").ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  auto content = static_cast<char*>(arraybuffer.Data());
+  auto owner = maybeOwner.IsExternal()
+      ? maybeOwner.As<Napi::External<rtc::CopyOnWriteBuffer>>().Data()
+      : nullptr;
+
+  // NOTE: rtc::CopyOnWriteBuffer cannot share a sub-range of its
+  // storage, so only SendBuffers sent in their entirety avoid the copy.
+  if (owner && owner->cdata() == reinterpret_cast<uint8_t*>(content)  // NOLINT
+      && byte_offset == 0 && byte_length == owner->size()) {
+    *sendBuffer = arraybuffer;
+    return std::unique_ptr<webrtc::DataBuffer>(new webrtc::DataBuffer(*owner, true));
+  }
+
+  rtc::CopyOnWriteBuffer buffer(content + byte_offset, byte_length);
+  return std::unique_ptr<webrtc::DataBuffer>(new webrtc::DataBuffer(buffer, true));
+}
+
 Napi::Value RTCDataChannel::Send(const Napi::CallbackInfo& info) {
   auto env = info.Env();
   if (_jingleDataChannel != nullptr) {
-    if (_jingleDataChannel->state() != webrtc::DataChannelInterface::DataState::kOpen) {
+    if (_cached_ready_state != webrtc::DataChannelInterface::DataState::kOpen) {
       Napi::Error(env, ErrorFactory::CreateInvalidStateError(env, "RTCDataChannel.readyState is not 'open'")).ThrowAsJavaScriptException();
       return env.Undefined();
     }
-    if (info[0].IsString()) {
-      auto str = info[0].ToString();
-      auto data = str.Utf8Value();
-
-      webrtc::DataBuffer buffer(data);
-      _jingleDataChannel->Send(buffer);
+    Napi::ArrayBuffer sendBuffer;
+    auto buffer = CreateDataBuffer(info[0], info[1], &sendBuffer);
+    if (!buffer) {
+      return env.Undefined();
+    }
+    auto size = buffer->size();
+    _bytes_submitted += size;
+    if (!_jingleDataChannel->Send(*buffer)) {
+      Unsubmit(size);
     } else {
-      Napi::ArrayBuffer arraybuffer;
-      size_t byte_offset = 0;
-      size_t byte_length = 0;
-
-      if (info[0].IsTypedArray()) {
-        auto typedArray = info[0].As<Napi::TypedArray>();
-        arraybuffer = typedArray.ArrayBuffer();
-        byte_offset = typedArray.ByteOffset();
-        byte_length = typedArray.ByteLength();
-      } else if (info[0].IsDataView()) {
-        auto dataView = info[0].As<Napi::DataView>();
-        arraybuffer = dataView.ArrayBuffer();
-        byte_offset = dataView.ByteOffset();
-        byte_length = dataView.ByteLength();
-      } else if (info[0].IsArrayBuffer()) {
-        arraybuffer = info[0].As<Napi::ArrayBuffer>();
-        byte_length = arraybuffer.ByteLength();
-      } else {
-        Napi::TypeError::New(env, "Expected a Blob or ArrayBuffer").ThrowAsJavaScriptException();
-        return env.Undefined();
+      _messages_submitted.fetch_add(1, std::memory_order_relaxed);
+      if (!sendBuffer.IsEmpty()) {
+        _pending_send_buffers.push_back({ _bytes_submitted, Napi::Persistent(sendBuffer) });
+        _pending_send_buffer_count++;
       }
-
-      auto content = static_cast<char*>(arraybuffer.Data());
-      rtc::CopyOnWriteBuffer buffer(content + byte_offset, byte_length);
-
-      webrtc::DataBuffer data_buffer(buffer, true);
-      _jingleDataChannel->Send(data_buffer);
     }
+    DidSend();
   } else {
     Napi::Error(env, ErrorFactory::CreateInvalidStateError(env, "RTCDataChannel.readyState is not 'open'")).ThrowAsJavaScriptException();
     return env.Undefined();
@@ -225,6 +478,171 @@ Napi::Value RTCDataChannel::Send(const Napi::CallbackInfo& info) {
   return env.Undefined();
 }
 
+Napi::Value RTCDataChannel::SendMany(const Napi::CallbackInfo& info) {
+  auto env = info.Env();
+  if (!info[0].IsArray()) {
+    Napi::TypeError::New(env, "Expected an Array").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  auto array = info[0].As<Napi::Array>();
+  auto length = array.Length();
+  auto owners = info[1].IsArray() ? info[1].As<Napi::Array>() : Napi::Array();
+
+  std::vector<std::unique_ptr<webrtc::DataBuffer>> buffers;
+  std::vector<Napi::ArrayBuffer> sendBuffers(length);
+  buffers.reserve(length);
+  for (uint32_t i = 0; i < length; i++) {
+    auto owner = owners.IsEmpty() ? env.Undefined() : owners.Get(i);
+    auto buffer = CreateDataBuffer(array.Get(i), owner, &sendBuffers[i]);
+    if (!buffer) {
+      return env.Undefined();
+    }
+    buffers.push_back(std::move(buffer));
+  }
+
+  if (_jingleDataChannel == nullptr) {
+    Napi::Error(env, ErrorFactory::CreateInvalidStateError(env, "RTCDataChannel.readyState is not 'open'")).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  // NOTE: Count every byte as submitted before sending, since
+  // OnBufferedAmountChange may run before Invoke returns.
+  uint64_t bytes = 0;
+  for (auto const& buffer : buffers) {
+    bytes += buffer->size();
+  }
+  uint64_t submitted = _bytes_submitted;
+  _bytes_submitted += bytes;
+
+  // NOTE: Every call through _jingleDataChannel blocks on the
+  // signaling thread, so we hop there once and call the DataChannel directly.
+  struct Result {
+    bool open;
+    uint32_t accepted;
+  };
+  auto channel = _jingleDataChannel;
+  auto result = _factory->_signalingThread->Invoke<Result>(RTC_FROM_HERE, [&channel, &buffers]() {
+    Result result = { channel->state() == webrtc::DataChannelInterface::DataState::kOpen, 0 };
+    if (result.open) {
+      for (auto const& buffer : buffers) {
+        if (!channel->Send(*buffer)) {
+          break;
+        }
+        result.accepted++;
+      }
+    }
+    return result;
+  });
+
+  uint64_t refused = 0;
+  for (uint32_t i = 0; i < length; i++) {
+    if (i >= result.accepted) {
+      refused += buffers[i]->size();
+      continue;
+    }
+    submitted += buffers[i]->size();
+    if (!sendBuffers[i].IsEmpty()) {
+      _pending_send_buffers.push_back({ submitted, Napi::Persistent(sendBuffers[i]) });
+      _pending_send_buffer_count++;
+    }
+  }
+  if (refused) {
+    Unsubmit(refused);
+  }
+  _messages_submitted.fetch_add(result.accepted, std::memory_order_relaxed);
+  DidSend();
+
+  if (!result.open) {
+    Napi::Error(env, ErrorFactory::CreateInvalidStateError(env, "RTCDataChannel.readyState is not 'open'")).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  CONVERT_OR_THROW_AND_RETURN_NAPI(env, result.accepted, accepted, Napi::Value)
+  return accepted;
+}
+
+void RTCDataChannel::DidSend() {
+  ReleaseSendBuffers();
+  uint64_t buffered_amount = _bytes_submitted - _bytes_sent;
+  if (buffered_amount <= _buffered_amount_low_threshold) {
+    _above_high_threshold = false;
+  } else if (_buffered_amount_high_threshold
+      && buffered_amount > _buffered_amount_high_threshold
+      && !_above_high_threshold) {
+    _above_high_threshold = true;
+    auto env = Env();
+    Napi::HandleScope scope(env);
+    auto object = Napi::Object::New(env);
+    object.Set("type", Napi::String::New(env, "bufferedamounthigh"));
+    MakeCallback("dispatchEvent", { object });
+  }
+}
+
+Napi::Value RTCDataChannel::CreateSendBuffer(const Napi::CallbackInfo& info) {
+  CONVERT_ARGS_OR_THROW_AND_RETURN_NAPI(info, byteLength, uint32_t)
+  // NOTE: An empty rtc::CopyOnWriteBuffer has no storage to share.
+  if (!byteLength) {
+    Napi::RangeError::New(info.Env(), "Expected byteLength to be greater than 0").ThrowAsJavaScriptException();
+    return info.Env().Undefined();
+  }
+  return NewSendBuffer(info.Env(), byteLength);
+}
+
+void RTCDataChannel::Unsubmit(uint64_t size) {
+  uint64_t buffered_amount = (_bytes_submitted -= size) - _bytes_sent;
+  uint64_t low = _buffered_amount_low_threshold;
+  if (buffered_amount <= low && buffered_amount + size > low) {
+    Dispatch(CreateCallback<RTCDataChannel>([this]() {
+      RTCDataChannel::HandleBufferedAmountLow(*this);
+    }), EventPriority::kBulk);
+  }
+}
+
+void RTCDataChannel::OnBufferedAmountChange(uint64_t sent_data_size) {
+  uint64_t sent = _bytes_sent += sent_data_size;
+  uint64_t buffered_amount = _bytes_submitted - sent;
+  uint64_t low = _buffered_amount_low_threshold;
+  auto crossed = buffered_amount <= low && buffered_amount + sent_data_size > low;
+  if (_bridge) {
+    _bridge->OnBufferedAmountChange(buffered_amount);
+  }
+  if (crossed || _pending_send_buffer_count) {
+    Dispatch(CreateCallback<RTCDataChannel>([this, crossed]() {
+      ReleaseSendBuffers();
+      if (crossed) {
+        RTCDataChannel::HandleBufferedAmountLow(*this);
+      }
+    }), EventPriority::kBulk);
+  }
+}
+
+void RTCDataChannel::HandleBufferedAmountLow(RTCDataChannel& channel) {
+  channel._above_high_threshold = false;
+  auto env = channel.Env();
+  Napi::HandleScope scope(env);
+  auto object = Napi::Object::New(env);
+  object.Set("type", Napi::String::New(env, "bufferedamountlow"));
+  channel.MakeCallback("dispatchEvent", { object });
+}
+
+void RTCDataChannel::ReleaseSendBuffers(bool all) {
+  if (_pending_send_buffers.empty()) {
+    return;
+  }
+  auto env = Env();
+  Napi::HandleScope scope(env);
+  uint64_t released = _bytes_sent;
+  while (!_pending_send_buffers.empty() && (all || _pending_send_buffers.front().release_at <= released)) {
+    auto buffer = _pending_send_buffers.front().buffer.Value();
+    _pending_send_buffers.pop_front();
+    _pending_send_buffer_count--;
+    auto object = Napi::Object::New(env);
+    object.Set("type", Napi::String::New(env, "sendbufferrelease"));
+    object.Set("buffer", buffer);
+    MakeCallback("dispatchEvent", { object });
+  }
+}
+
 Napi::Value RTCDataChannel::Close(const Napi::CallbackInfo& info) {
   if (_jingleDataChannel != nullptr) {
     _jingleDataChannel->Close();
@@ -232,59 +650,237 @@ Napi::Value RTCDataChannel::Close(const Napi::CallbackInfo& info) {
   return info.Env().Undefined();
 }
 
+Napi::Value RTCDataChannel::Pause(const Napi::CallbackInfo& info) {
+  std::lock_guard<std::mutex> lock(_message_mutex);
+  _paused = true;
+  return info.Env().Undefined();
+}
+
+Napi::Value RTCDataChannel::Resume(const Napi::CallbackInfo& info) {
+  ResumeMessages();
+  return info.Env().Undefined();
+}
+
+/**
+ * Convert a value passed to `bridgeTo` into a DataChannelBridge::Target. If the
+ * value is invalid, this throws and returns false.
+ */
+static bool CreateBridgeTarget(const Napi::Value& value, DataChannelBridge::Target* target) {
+  auto env = value.Env();
+  if (value.IsNumber()) {
+    auto maybeFd = From<int32_t>(value);
+    if (maybeFd.IsValid() && maybeFd.UnsafeFromValid() >= 0) {
+      target->fd = maybeFd.UnsafeFromValid();
+      return true;
+    }
+  } else if (value.IsObject()) {
+    auto object = value.As<Napi::Object>();
+    if (object.Has("path")) {
+      auto maybePath = From<std::string>(object.Get("path"));
+      if (maybePath.IsValid() && !maybePath.UnsafeFromValid().empty()) {
+        target->path = maybePath.UnsafeFromValid();
+        return true;
+      }
+    } else {
+      auto maybeHost = From<std::string>(object.Get("host"));
+      auto maybePort = From<uint16_t>(object.Get("port"));
+      if (maybeHost.IsValid() && maybePort.IsValid()) {
+        target->host = maybeHost.UnsafeFromValid();
+        target->port = maybePort.UnsafeFromValid();
+        return true;
+      }
+    }
+  }
+  Napi::TypeError::New(env, "Expected a file descriptor, { path }, or { host, port }").ThrowAsJavaScriptException();
+  return false;
+}
+
+Napi::Value RTCDataChannel::BridgeTo(const Napi::CallbackInfo& info) {
+  auto env = info.Env();
+  DataChannelBridge::Target target;
+  if (!CreateBridgeTarget(info[0], &target)) {
+    return env.Undefined();
+  }
+
+  // NOTE: Hold reading from the socket while more than this many
+  // bytes are waiting to be sent.
+  auto highWaterMark = _buffered_amount_high_threshold
+      ? _buffered_amount_high_threshold
+      : 1024 * 1024;
+
+  rtc::scoped_refptr<DataChannelBridge> bridge = new rtc::RefCountedObject<DataChannelBridge>(
+          this, _factory->_signalingThread.get(), _factory->_workerThread.get(), highWaterMark);
+  auto installed = _factory->_signalingThread->Invoke<bool>(RTC_FROM_HERE, [this, &bridge]() {
+    if (_bridge || !_jingleDataChannel || _cached_ready_state == webrtc::DataChannelInterface::kClosing) {
+      return false;
+    }
+    _bridge = bridge;
+    return true;
+  });
+  if (!installed) {
+    Napi::Error(env, ErrorFactory::CreateInvalidStateError(env, "RTCDataChannel is already bridged or is not open")).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  bridge->Start(target);
+  return env.Undefined();
+}
+
+bool RTCDataChannel::SendFromBridge(const rtc::CopyOnWriteBuffer& data) {
+  if (!_jingleDataChannel) {
+    return false;
+  }
+  auto size = data.size();
+  _bytes_submitted += size;
+  if (!_jingleDataChannel->Send(webrtc::DataBuffer(data, true))) {
+    Unsubmit(size);
+    return false;
+  }
+  _messages_submitted.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void RTCDataChannel::OnBridgeOpen() {
+  Dispatch(CreateCallback<RTCDataChannel>([this]() {
+    auto env = Env();
+    Napi::HandleScope scope(env);
+    auto object = Napi::Object::New(env);
+    object.Set("type", Napi::String::New(env, "bridgeopen"));
+    MakeCallback("dispatchEvent", { object });
+  }), EventPriority::kBulk);
+}
+
+void RTCDataChannel::OnBridgeClosed(const std::string& error) {
+  _bridge = nullptr;
+  Dispatch(CreateCallback<RTCDataChannel>([this, error]() {
+    auto env = Env();
+    Napi::HandleScope scope(env);
+    auto object = Napi::Object::New(env);
+    object.Set("type", Napi::String::New(env, "bridgeclose"));
+    if (!error.empty()) {
+      object.Set("error", Napi::Error::New(env, error).Value());
+    }
+    MakeCallback("dispatchEvent", { object });
+  }), EventPriority::kBulk);
+  // NOTE: The relay is one-to-one, so when the socket goes away, so
+  // does the RTCDataChannel.
+  if (_jingleDataChannel) {
+    _jingleDataChannel->Close();
+  }
+}
+
+void RTCDataChannel::StopBridge() {
+  if (!_bridge) {
+    return;
+  }
+  _bridge->Stop();
+  _bridge = nullptr;
+  Dispatch(CreateCallback<RTCDataChannel>([this]() {
+    auto env = Env();
+    Napi::HandleScope scope(env);
+    auto object = Napi::Object::New(env);
+    object.Set("type", Napi::String::New(env, "bridgeclose"));
+    MakeCallback("dispatchEvent", { object });
+  }), EventPriority::kBulk);
+}
+
+Napi::Value RTCDataChannel::JsSetQueueLimit(const Napi::CallbackInfo& info) {
+  CONVERT_ARGS_OR_THROW_AND_RETURN_NAPI(info, limit, EventQueueLimit)
+  // NOTE: Messages arrive on the network thread, which every
+  // connection shares, so we never block it.
+  if (limit.policy == OverflowPolicy::kBlock) {
+    Napi::TypeError::New(info.Env(), "RTCDataChannel does not support the \"block\" policy").ThrowAsJavaScriptException();
+    return info.Env().Undefined();
+  }
+  SetQueueLimit(limit.capacity, limit.policy);
+  return info.Env().Undefined();
+}
+
+Napi::Value RTCDataChannel::GetNativeStats(const Napi::CallbackInfo& info) {
+  auto env = info.Env();
+  auto histogram = Napi::Array::New(env, LatencyHistogram::kBuckets);
+  for (uint32_t i = 0; i < LatencyHistogram::kBuckets; i++) {
+    auto bucket = Napi::Object::New(env);
+    bucket.Set("lessThan", i + 1 < LatencyHistogram::kBuckets
+        ? Napi::Number::New(env, LatencyHistogram::UpperBound(i))
+        : Napi::Number::New(env, std::numeric_limits<double>::infinity()));
+    bucket.Set("count", Napi::Number::New(env, _dispatch_latency.count(i)));
+    histogram.Set(i, bucket);
+  }
+  auto stats = Napi::Object::New(env);
+  stats.Set("messagesReceived", Napi::Number::New(env, _messages_received.load(std::memory_order_relaxed)));
+  stats.Set("bytesReceived", Napi::Number::New(env, _bytes_received.load(std::memory_order_relaxed)));
+  stats.Set("messagesSent", Napi::Number::New(env, _messages_submitted.load(std::memory_order_relaxed)));
+  stats.Set("bytesSent", Napi::Number::New(env, _bytes_submitted));
+  stats.Set("queueDepth", Napi::Number::New(env, queue_depth()));
+  stats.Set("peakQueueDepth", Napi::Number::New(env, peak_queue_depth()));
+  stats.Set("dispatchLatency", histogram);
+  return stats;
+}
+
 Napi::Value RTCDataChannel::GetBufferedAmount(const Napi::CallbackInfo& info) {
-  uint64_t buffered_amount = _jingleDataChannel != nullptr
-      ? _jingleDataChannel->buffered_amount()
-      : _cached_buffered_amount;
+  uint64_t buffered_amount = _bytes_submitted - _bytes_sent;
   CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), buffered_amount, result, Napi::Value)
   return result;
 }
 
+Napi::Value RTCDataChannel::GetBufferedAmountLowThreshold(const Napi::CallbackInfo& info) {
+  uint64_t threshold = _buffered_amount_low_threshold;
+  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), threshold, result, Napi::Value)
+  return result;
+}
+
+void RTCDataChannel::SetBufferedAmountLowThreshold(const Napi::CallbackInfo& info, const Napi::Value& value) {
+  auto maybeThreshold = From<uint64_t>(value);
+  if (maybeThreshold.IsInvalid()) {
+    Napi::TypeError::New(info.Env(), maybeThreshold.ToErrors()[0]).ThrowAsJavaScriptException();
+    return;
+  }
+  _buffered_amount_low_threshold = maybeThreshold.UnsafeFromValid();
+}
+
+Napi::Value RTCDataChannel::GetBufferedAmountHighThreshold(const Napi::CallbackInfo& info) {
+  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), _buffered_amount_high_threshold, result, Napi::Value)
+  return result;
+}
+
+void RTCDataChannel::SetBufferedAmountHighThreshold(const Napi::CallbackInfo& info, const Napi::Value& value) {
+  auto maybeThreshold = From<uint64_t>(value);
+  if (maybeThreshold.IsInvalid()) {
+    Napi::TypeError::New(info.Env(), maybeThreshold.ToErrors()[0]).ThrowAsJavaScriptException();
+    return;
+  }
+  _buffered_amount_high_threshold = maybeThreshold.UnsafeFromValid();
+}
+
 Napi::Value RTCDataChannel::GetId(const Napi::CallbackInfo& info) {
-  auto id = _jingleDataChannel
-      ? _jingleDataChannel->id()
-      : _cached_id;
+  int id = _cached_id;
   CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), id, result, Napi::Value)
   return result;
 }
 
 Napi::Value RTCDataChannel::GetLabel(const Napi::CallbackInfo& info) {
-  auto label = _jingleDataChannel != nullptr
-      ? _jingleDataChannel->label()
-      : _cached_label;
-  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), label, result, Napi::Value)
+  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), _cached_label, result, Napi::Value)
   return result;
 }
 
 Napi::Value RTCDataChannel::GetMaxPacketLifeTime(const Napi::CallbackInfo& info) {
-  auto max_packet_life_time = _jingleDataChannel
-      ? _jingleDataChannel->maxRetransmitTime()
-      : _cached_max_packet_life_time;
-  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), max_packet_life_time, result, Napi::Value)
+  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), _cached_max_packet_life_time, result, Napi::Value)
   return result;
 }
 
 Napi::Value RTCDataChannel::GetMaxRetransmits(const Napi::CallbackInfo& info) {
-  auto max_retransmits = _jingleDataChannel
-      ? _jingleDataChannel->maxRetransmits()
-      : _cached_max_retransmits;
-  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), max_retransmits, result, Napi::Value)
+  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), _cached_max_retransmits, result, Napi::Value)
   return result;
 }
 
 Napi::Value RTCDataChannel::GetNegotiated(const Napi::CallbackInfo& info) {
-  auto negotiated = _jingleDataChannel
-      ? _jingleDataChannel->negotiated()
-      : _cached_negotiated;
-  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), negotiated, result, Napi::Value)
+  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), _cached_negotiated, result, Napi::Value)
   return result;
 }
 
 Napi::Value RTCDataChannel::GetOrdered(const Napi::CallbackInfo& info) {
-  auto ordered = _jingleDataChannel
-      ? _jingleDataChannel->ordered()
-      : _cached_ordered;
-  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), ordered, result, Napi::Value)
+  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), _cached_ordered, result, Napi::Value)
   return result;
 }
 
@@ -295,17 +891,12 @@ Napi::Value RTCDataChannel::GetPriority(const Napi::CallbackInfo& info) {
 }
 
 Napi::Value RTCDataChannel::GetProtocol(const Napi::CallbackInfo& info) {
-  auto protocol = _jingleDataChannel
-      ? _jingleDataChannel->protocol()
-      : _cached_protocol;
-  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), protocol, result, Napi::Value)
+  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), _cached_protocol, result, Napi::Value)
   return result;
 }
 
 Napi::Value RTCDataChannel::GetReadyState(const Napi::CallbackInfo& info) {
-  auto state = _jingleDataChannel
-      ? _jingleDataChannel->state()
-      : webrtc::DataChannelInterface::kClosed;
+  webrtc::DataChannelInterface::DataState state = _cached_ready_state;
   CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), state, result, Napi::Value)
   return result;
 }
@@ -315,6 +906,21 @@ Napi::Value RTCDataChannel::GetBinaryType(const Napi::CallbackInfo& info) {
   return result;
 }
 
+Napi::Value RTCDataChannel::GetBatchMessages(const Napi::CallbackInfo& info) {
+  bool batchMessages = _batch_messages;
+  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), batchMessages, result, Napi::Value)
+  return result;
+}
+
+void RTCDataChannel::SetBatchMessages(const Napi::CallbackInfo& info, const Napi::Value& value) {
+  auto maybeBatchMessages = From<bool>(value);
+  if (maybeBatchMessages.IsInvalid()) {
+    Napi::TypeError::New(info.Env(), maybeBatchMessages.ToErrors()[0]).ThrowAsJavaScriptException();
+    return;
+  }
+  _batch_messages = maybeBatchMessages.UnsafeFromValid();
+}
+
 void RTCDataChannel::SetBinaryType(const Napi::CallbackInfo& info, const Napi::Value& value) {
   auto maybeBinaryType = From<BinaryType>(value);
   if (maybeBinaryType.IsInvalid()) {
@@ -352,7 +958,11 @@ RTCDataChannel* RTCDataChannel::Create(
 
 void RTCDataChannel::Init(Napi::Env env, Napi::Object exports) {
   auto func = DefineClass(env, "RTCDataChannel", {
+    CallbackProperty("dispatchEvent"),
     InstanceAccessor("bufferedAmount", &RTCDataChannel::GetBufferedAmount, nullptr),
+    InstanceAccessor("droppedEvents", &RTCDataChannel::GetDroppedEvents, nullptr),
+    InstanceAccessor("bufferedAmountLowThreshold", &RTCDataChannel::GetBufferedAmountLowThreshold, &RTCDataChannel::SetBufferedAmountLowThreshold),
+    InstanceAccessor("bufferedAmountHighThreshold", &RTCDataChannel::GetBufferedAmountHighThreshold, &RTCDataChannel::SetBufferedAmountHighThreshold),
     InstanceAccessor("id", &RTCDataChannel::GetId, nullptr),
     InstanceAccessor("label", &RTCDataChannel::GetLabel, nullptr),
     InstanceAccessor("maxPacketLifeTime", &RTCDataChannel::GetMaxPacketLifeTime, nullptr),
@@ -362,9 +972,17 @@ void RTCDataChannel::Init(Napi::Env env, Napi::Object exports) {
     InstanceAccessor("priority", &RTCDataChannel::GetPriority, nullptr),
     InstanceAccessor("protocol", &RTCDataChannel::GetProtocol, nullptr),
     InstanceAccessor("binaryType", &RTCDataChannel::GetBinaryType, &RTCDataChannel::SetBinaryType),
+    InstanceAccessor("batchMessages", &RTCDataChannel::GetBatchMessages, &RTCDataChannel::SetBatchMessages),
     InstanceAccessor("readyState", &RTCDataChannel::GetReadyState, nullptr),
+    InstanceMethod("bridgeTo", &RTCDataChannel::BridgeTo),
     InstanceMethod("close", &RTCDataChannel::Close),
-    InstanceMethod("_send", &RTCDataChannel::Send)
+    InstanceMethod("getNativeStats", &RTCDataChannel::GetNativeStats),
+    InstanceMethod("_pause", &RTCDataChannel::Pause),
+    InstanceMethod("_resume", &RTCDataChannel::Resume),
+    InstanceMethod("_createSendBuffer", &RTCDataChannel::CreateSendBuffer),
+    InstanceMethod("_send", &RTCDataChannel::Send),
+    InstanceMethod("_sendMany", &RTCDataChannel::SendMany),
+    InstanceMethod("setQueueLimit", &RTCDataChannel::JsSetQueueLimit)
   });
 
   constructor() = Napi::Persistent(func);
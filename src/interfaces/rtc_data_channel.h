@@ -7,16 +7,22 @@
  */
 #pragma once
 
+#include <atomic>
+#include <deque>
 #include <iosfwd>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <webrtc/api/data_channel_interface.h>
 #include <webrtc/api/scoped_refptr.h>
 
 #include "src/enums/node_webrtc/binary_type.h"
+#include "src/interfaces/rtc_data_channel/data_channel_bridge.h"
 #include "src/node/event_queue.h"
 #include "src/node/async_object_wrap_with_loop.h"
 #include "src/node/wrap.h"
+#include "src/utilities/latency_histogram.h"
 
 namespace node_webrtc {
 
@@ -27,6 +33,7 @@ class RTCDataChannel
   : public AsyncObjectWrapWithLoop<RTCDataChannel>
   , public webrtc::DataChannelObserver {
   friend class node_webrtc::DataChannelObserver;
+  friend class node_webrtc::DataChannelBridge;
  public:
   explicit RTCDataChannel(const Napi::CallbackInfo&);
 
@@ -36,11 +43,18 @@ class RTCDataChannel
 
   static void Init(Napi::Env, Napi::Object);
 
+  /**
+   * The most bytes of received messages held while paused. A message beyond
+   * it raises "error" and closes the RTCDataChannel.
+   */
+  static constexpr size_t kMaxPausedBytes = 16 * 1024 * 1024;
+
   //
   // DataChannelObserver implementation.
   //
   void OnStateChange() override;
   void OnMessage(const webrtc::DataBuffer& buffer) override;
+  void OnBufferedAmountChange(uint64_t sent_data_size) override;
 
   void OnPeerConnectionClosed();
 
@@ -56,12 +70,25 @@ class RTCDataChannel
       rtc::scoped_refptr<webrtc::DataChannelInterface>);
 
   static void HandleStateChange(RTCDataChannel&, webrtc::DataChannelInterface::DataState);
-  static void HandleMessage(RTCDataChannel&, const webrtc::DataBuffer& buffer);
+  static void HandleMessage(RTCDataChannel&, webrtc::DataBuffer&& buffer);
+  static void HandleMessages(RTCDataChannel&);
+  static void HandleBufferedAmountLow(RTCDataChannel&);
 
   Napi::Value Send(const Napi::CallbackInfo&);
+  Napi::Value SendMany(const Napi::CallbackInfo&);
   Napi::Value Close(const Napi::CallbackInfo&);
+  Napi::Value CreateSendBuffer(const Napi::CallbackInfo&);
+  Napi::Value Pause(const Napi::CallbackInfo&);
+  Napi::Value Resume(const Napi::CallbackInfo&);
+  Napi::Value BridgeTo(const Napi::CallbackInfo&);
+  Napi::Value GetNativeStats(const Napi::CallbackInfo&);
+  Napi::Value JsSetQueueLimit(const Napi::CallbackInfo&);
 
   Napi::Value GetBufferedAmount(const Napi::CallbackInfo&);
+  Napi::Value GetBufferedAmountLowThreshold(const Napi::CallbackInfo&);
+  void SetBufferedAmountLowThreshold(const Napi::CallbackInfo&, const Napi::Value&);
+  Napi::Value GetBufferedAmountHighThreshold(const Napi::CallbackInfo&);
+  void SetBufferedAmountHighThreshold(const Napi::CallbackInfo&, const Napi::Value&);
   Napi::Value GetId(const Napi::CallbackInfo&);
   Napi::Value GetLabel(const Napi::CallbackInfo&);
   Napi::Value GetMaxPacketLifeTime(const Napi::CallbackInfo&);
@@ -73,18 +100,92 @@ class RTCDataChannel
   Napi::Value GetBinaryType(const Napi::CallbackInfo&);
   Napi::Value GetReadyState(const Napi::CallbackInfo&);
   void SetBinaryType(const Napi::CallbackInfo&, const Napi::Value&);
+  Napi::Value GetBatchMessages(const Napi::CallbackInfo&);
+  void SetBatchMessages(const Napi::CallbackInfo&, const Napi::Value&);
 
   void CleanupInternals();
 
+  /**
+   * Dispatch a received message (or add it to the current batch). Call with
+   * _message_mutex held.
+   */
+  void DispatchMessage(const webrtc::DataBuffer&);
+
+  /**
+   * Stop holding received messages and dispatch any held so far.
+   */
+  void ResumeMessages();
+
+  /**
+   * Raise "sendbufferrelease" for every SendBuffer libwebrtc no longer
+   * references (or, if `all` is true, for every pending SendBuffer).
+   */
+  void ReleaseSendBuffers(bool all = false);
+
+  /**
+   * Call after sending. This releases SendBuffers and raises
+   * "bufferedamounthigh" if the buffered amount crossed the high threshold.
+   */
+  void DidSend();
+
+  /**
+   * Stop counting `size` bytes libwebrtc refused to send. This raises
+   * "bufferedamountlow" if the buffered amount crossed the low threshold,
+   * since OnBufferedAmountChange may have missed it while they were counted.
+   */
+  void Unsubmit(uint64_t size);
+
+  //
+  // DataChannelBridge calls these on the signaling thread.
+  //
+  bool SendFromBridge(const rtc::CopyOnWriteBuffer&);
+  void OnBridgeOpen();
+  void OnBridgeClosed(const std::string& error);
+
+  /**
+   * Stop the DataChannelBridge, if any. Call on the signaling thread.
+   */
+  void StopBridge();
+
+  struct PendingSendBuffer {
+    uint64_t release_at;
+    Napi::Reference<Napi::ArrayBuffer> buffer;
+  };
+
   BinaryType _binaryType;
-  int _cached_id;
+  std::atomic<int> _cached_id = {0};
   std::string _cached_label;
-  uint16_t _cached_max_packet_life_time;
-  uint16_t _cached_max_retransmits;
-  bool _cached_negotiated;
-  bool _cached_ordered;
+  uint16_t _cached_max_packet_life_time = 0;
+  uint16_t _cached_max_retransmits = 0;
+  bool _cached_negotiated = false;
+  bool _cached_ordered = false;
   std::string _cached_protocol;
-  uint64_t _cached_buffered_amount;
+  std::atomic<webrtc::DataChannelInterface::DataState> _cached_ready_state = {webrtc::DataChannelInterface::kConnecting};
+  // NOTE: libwebrtc calls OnBufferedAmountChange for every message
+  // it hands to the SCTP transport, so the buffered amount is always
+  // _bytes_submitted - _bytes_sent.
+  std::atomic<uint64_t> _bytes_submitted = {0};
+  std::atomic<uint64_t> _bytes_sent = {0};
+  std::atomic<uint64_t> _buffered_amount_low_threshold = {0};
+  uint64_t _buffered_amount_high_threshold = 0;
+  bool _above_high_threshold = false;
+  std::deque<PendingSendBuffer> _pending_send_buffers;
+  std::atomic<size_t> _pending_send_buffer_count = {0};
+  std::atomic<bool> _batch_messages = {false};
+  std::mutex _message_mutex;
+  std::vector<webrtc::DataBuffer> _batch;
+  bool _paused = false;
+  std::vector<webrtc::DataBuffer> _paused_messages;
+  size_t _paused_bytes = 0;
+  bool _paused_overflowed = false;
+  // NOTE: Only accessed on the signaling thread.
+  rtc::scoped_refptr<DataChannelBridge> _bridge;
+  // NOTE: These are reported by getNativeStats. They are only ever
+  // updated with relaxed atomic increments, so they are always on.
+  std::atomic<uint64_t> _messages_received = {0};
+  std::atomic<uint64_t> _bytes_received = {0};
+  std::atomic<uint64_t> _messages_submitted = {0};
+  LatencyHistogram _dispatch_latency;
   PeerConnectionFactory* _factory;
   rtc::scoped_refptr<webrtc::DataChannelInterface> _jingleDataChannel;
 };
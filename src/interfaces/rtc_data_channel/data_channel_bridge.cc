@@ -0,0 +1,316 @@
+/* Copyright (c) 2019 The node-webrtc project authors. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found
+ * in the LICENSE.md file in the root of the source tree. All contributing
+ * project authors may be found in the AUTHORS file in the root of the source
+ * tree.
+ */
+#include "src/interfaces/rtc_data_channel/data_channel_bridge.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <webrtc/api/scoped_refptr.h>
+#include <webrtc/rtc_base/async_socket.h>
+#include <webrtc/rtc_base/location.h>
+#include <webrtc/rtc_base/physical_socket_server.h>
+#include <webrtc/rtc_base/socket.h>
+#include <webrtc/rtc_base/socket_address.h>
+#include <webrtc/rtc_base/thread.h>
+
+#ifdef WEBRTC_POSIX
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "src/interfaces/rtc_data_channel.h"
+
+namespace node_webrtc {
+
+// NOTE: Browsers interoperate reliably with messages up to 16 KiB.
+static const size_t kReadSize = 16384;
+
+// NOTE: libwebrtc has no receive-side flow control, so a socket that does not
+// keep up can only be given up on.
+static const size_t kMaxQueuedWriteBytes = 16 * 1024 * 1024;
+
+DataChannelBridge::DataChannelBridge(
+    RTCDataChannel* channel,
+    rtc::Thread* signalingThread,
+    rtc::Thread* networkThread,
+    uint64_t highWaterMark)
+  : _channel(channel)
+  , _signalingThread(signalingThread)
+  , _networkThread(networkThread)
+  , _high_water_mark(highWaterMark) {
+}
+
+DataChannelBridge::~DataChannelBridge() = default;
+
+void DataChannelBridge::Start(const Target& target) {
+  rtc::scoped_refptr<DataChannelBridge> self(this);
+  _networkThread->PostTask(RTC_FROM_HERE, [self, target]() {
+    self->Connect(target);
+  });
+}
+
+void DataChannelBridge::OnMessage(const webrtc::DataBuffer& buffer) {
+  rtc::scoped_refptr<DataChannelBridge> self(this);
+  auto data = buffer.data;
+  _networkThread->PostTask(RTC_FROM_HERE, [self, data]() {
+    if (self->_closed) {
+      return;
+    }
+    if (self->_queued_write_bytes + data.size() > kMaxQueuedWriteBytes) {
+      self->Close("The socket is not keeping up with the RTCDataChannel");
+      return;
+    }
+    self->_queued_write_bytes += data.size();
+    self->_writes.push_back(data);
+    self->Write();
+  });
+}
+
+void DataChannelBridge::OnBufferedAmountChange(uint64_t bufferedAmount) {
+  _buffered_amount = bufferedAmount;
+  MaybeResumeReading();
+}
+
+void DataChannelBridge::Stop() {
+  std::lock_guard<std::recursive_mutex> lock(_channel_mutex);
+  if (!_channel) {
+    return;
+  }
+  _channel = nullptr;
+  rtc::scoped_refptr<DataChannelBridge> self(this);
+  _networkThread->PostTask(RTC_FROM_HERE, [self]() {
+    self->_closing = true;
+    self->Write();
+  });
+}
+
+void DataChannelBridge::Connect(const Target& target) {
+  // NOTE: The network thread is created with
+  // rtc::Thread::CreateWithSocketServer, so its SocketServer is a
+  // PhysicalSocketServer.
+  auto server = static_cast<rtc::PhysicalSocketServer*>(_networkThread->socketserver());
+  rtc::AsyncSocket* socket = nullptr;
+  auto connected = false;
+
+  if (target.fd >= 0 || !target.path.empty()) {
+#ifdef WEBRTC_POSIX
+    // NOTE: The caller keeps its file descriptor; we close our own duplicate.
+    auto fd = target.fd >= 0 ? ::dup(target.fd) : -1;
+    if (target.fd >= 0 && fd < 0) {
+      Close(strerror(errno));
+      return;
+    }
+    auto flags = fd >= 0 ? ::fcntl(fd, F_GETFL) : -1;
+    if (fd < 0) {
+      sockaddr_un address = {};
+      address.sun_family = AF_UNIX;
+      if (target.path.size() >= sizeof(address.sun_path)) {
+        Close("Unix socket path is too long");
+        return;
+      }
+      memcpy(address.sun_path, target.path.c_str(), target.path.size());
+      fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+      if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {  // NOLINT
+        std::string error = strerror(errno);
+        if (fd >= 0) {
+          ::close(fd);
+        }
+        Close(error);
+        return;
+      }
+    }
+    socket = server->WrapSocket(fd);
+    connected = socket != nullptr;
+    if (socket && target.fd >= 0) {
+      _fd = fd;
+      _fd_flags = flags;
+    }
+#else
+    Close("File descriptors and Unix sockets are not supported on this platform");
+    return;
+#endif
+  } else {
+    rtc::SocketAddress address(target.host, target.port);
+    auto family = address.IsUnresolvedIP() ? AF_INET : address.ipaddr().family();
+    socket = server->CreateAsyncSocket(family, SOCK_STREAM);
+    if (socket && socket->Connect(address) == SOCKET_ERROR) {
+      std::string error = strerror(socket->GetError());
+      delete socket;
+      Close(error);
+      return;
+    }
+  }
+
+  if (!socket) {
+    Close("Failed to create socket");
+    return;
+  }
+
+  _socket.reset(socket);
+  _self = this;
+  _socket->SignalConnectEvent.connect(this, &DataChannelBridge::OnConnectEvent);
+  _socket->SignalReadEvent.connect(this, &DataChannelBridge::OnReadEvent);
+  _socket->SignalWriteEvent.connect(this, &DataChannelBridge::OnWriteEvent);
+  _socket->SignalCloseEvent.connect(this, &DataChannelBridge::OnCloseEvent);
+
+  if (connected) {
+    OnConnectEvent(_socket.get());
+  }
+}
+
+void DataChannelBridge::OnConnectEvent(rtc::AsyncSocket*) {
+  if (_closed) {
+    return;
+  }
+  _connected = true;
+  rtc::scoped_refptr<DataChannelBridge> self(this);
+  _signalingThread->PostTask(RTC_FROM_HERE, [self]() {
+    std::lock_guard<std::recursive_mutex> lock(self->_channel_mutex);
+    if (self->_channel) {
+      self->_channel->OnBridgeOpen();
+    }
+  });
+  Write();
+  Read();
+}
+
+void DataChannelBridge::OnReadEvent(rtc::AsyncSocket*) {
+  Read();
+}
+
+void DataChannelBridge::OnWriteEvent(rtc::AsyncSocket*) {
+  Write();
+}
+
+void DataChannelBridge::OnCloseEvent(rtc::AsyncSocket*, int error) {
+  Close(error ? strerror(error) : "");
+}
+
+void DataChannelBridge::Read() {
+  rtc::scoped_refptr<DataChannelBridge> self(this);
+  while (!_closed && _connected && !_read_paused) {
+    rtc::CopyOnWriteBuffer data(kReadSize);
+    auto received = _socket->Recv(data.data(), kReadSize, nullptr);
+    if (received <= 0) {
+      // NOTE: PhysicalSocket reports EOF as a blocking error and
+      // raises SignalCloseEvent afterwards.
+      if (!rtc::IsBlockingError(_socket->GetError())) {
+        Close(strerror(_socket->GetError()));
+      }
+      return;
+    }
+    data.SetSize(received);
+    _unsubmitted += received;
+    _signalingThread->PostTask(RTC_FROM_HERE, [self, data]() {
+      self->SendToChannel(data);
+    });
+    if (_unsubmitted + _buffered_amount > _high_water_mark) {
+      // NOTE: Not calling Recv leaves the socket's read events
+      // disabled, which pushes back on the sender. The signaling thread may
+      // have drained in the meantime; whichever thread clears _read_paused
+      // resumes reading.
+      _read_paused = true;
+      if (_unsubmitted + _buffered_amount > _high_water_mark / 2 || !_read_paused.exchange(false)) {
+        return;
+      }
+    }
+  }
+}
+
+void DataChannelBridge::Write() {
+  while (!_closed && _connected && !_writes.empty()) {
+    auto const& data = _writes.front();
+    auto sent = _socket->Send(data.cdata() + _write_offset, data.size() - _write_offset);
+    if (sent < 0) {
+      if (!rtc::IsBlockingError(_socket->GetError())) {
+        Close(strerror(_socket->GetError()));
+      }
+      return;
+    }
+    _write_offset += sent;
+    if (_write_offset == data.size()) {
+      _queued_write_bytes -= data.size();
+      _writes.pop_front();
+      _write_offset = 0;
+    }
+  }
+  if (_closing && (_writes.empty() || !_connected)) {
+    Close("");
+  }
+}
+
+void DataChannelBridge::Close(const std::string& error) {
+  if (_closed) {
+    return;
+  }
+  _closed = true;
+  _writes.clear();
+  _queued_write_bytes = 0;
+  rtc::scoped_refptr<DataChannelBridge> self(this);
+  if (_socket) {
+#ifdef WEBRTC_POSIX
+    // NOTE: Our duplicate shares the caller's file status flags, which
+    // the socket server made non-blocking.
+    if (_fd >= 0 && _fd_flags >= 0) {
+      ::fcntl(_fd, F_SETFL, _fd_flags);
+    }
+    _fd = -1;
+#endif
+    _socket->Close();
+    // NOTE: We may be inside one of the socket's own signals, so destroy
+    // it in a later task, still on the network thread.
+    _networkThread->PostTask(RTC_FROM_HERE, [self]() {
+      self->_socket.reset();
+      self->_self = nullptr;
+    });
+  }
+  _signalingThread->PostTask(RTC_FROM_HERE, [self, error]() {
+    self->Closed(error);
+  });
+}
+
+void DataChannelBridge::SendToChannel(const rtc::CopyOnWriteBuffer& data) {
+  // NOTE: Count the bytes as buffered before handing them over, so
+  // that reading never resumes early. OnBufferedAmountChange then replaces the
+  // estimate with the RTCDataChannel's own buffered amount.
+  _buffered_amount += data.size();
+  _unsubmitted -= data.size();
+  std::lock_guard<std::recursive_mutex> lock(_channel_mutex);
+  if (!_channel) {
+    return;
+  }
+  if (!_channel->SendFromBridge(data)) {
+    rtc::scoped_refptr<DataChannelBridge> self(this);
+    _networkThread->PostTask(RTC_FROM_HERE, [self]() {
+      self->Close("RTCDataChannel did not accept a message");
+    });
+  }
+}
+
+void DataChannelBridge::MaybeResumeReading() {
+  if (_unsubmitted + _buffered_amount <= _high_water_mark / 2 && _read_paused.exchange(false)) {
+    rtc::scoped_refptr<DataChannelBridge> self(this);
+    _networkThread->PostTask(RTC_FROM_HERE, [self]() {
+      self->Read();
+    });
+  }
+}
+
+void DataChannelBridge::Closed(const std::string& error) {
+  std::lock_guard<std::recursive_mutex> lock(_channel_mutex);
+  if (!_channel) {
+    return;
+  }
+  auto channel = _channel;
+  _channel = nullptr;
+  channel->OnBridgeClosed(error);
+}
+
+}  // namespace node_webrtc
@@ -0,0 +1,133 @@
+/* Copyright (c) 2019 The node-webrtc project authors. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found
+ * in the LICENSE.md file in the root of the source tree. All contributing
+ * project authors may be found in the AUTHORS file in the root of the source
+ * tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <webrtc/api/data_channel_interface.h>
+#include <webrtc/api/scoped_refptr.h>
+#include <webrtc/rtc_base/copy_on_write_buffer.h>
+#include <webrtc/rtc_base/ref_count.h>
+#include <webrtc/rtc_base/third_party/sigslot/sigslot.h>
+
+namespace rtc {
+
+class AsyncSocket;
+class Thread;
+
+}  // namespace rtc
+
+namespace node_webrtc {
+
+class RTCDataChannel;
+
+/**
+ * A DataChannelBridge relays bytes between an RTCDataChannel and a stream
+ * socket without involving the JavaScript thread. The socket is serviced on
+ * the network thread, and the RTCDataChannel is used from the signaling thread.
+ * The two threads only ever post to one another, since libwebrtc itself
+ * Invokes the network thread from the signaling thread.
+ */
+class DataChannelBridge
+  : public rtc::RefCountInterface
+  , public sigslot::has_slots<sigslot::multi_threaded_local> {
+ public:
+  /**
+   * Exactly one of a file descriptor, a Unix socket path, or a host and port.
+   * A file descriptor is duplicated, so the caller still owns it. The
+   * duplicate shares its file status flags, so the file descriptor is
+   * non-blocking until the bridge closes, which restores them.
+   */
+  struct Target {
+    int fd = -1;
+    std::string path;
+    std::string host;
+    uint16_t port = 0;
+  };
+
+  DataChannelBridge(
+      RTCDataChannel* channel,
+      rtc::Thread* signalingThread,
+      rtc::Thread* networkThread,
+      uint64_t highWaterMark);
+
+  ~DataChannelBridge() override;
+
+  /**
+   * Connect to the target. Call once.
+   */
+  void Start(const Target&);
+
+  //
+  // Call the following on the signaling thread.
+  //
+  void OnMessage(const webrtc::DataBuffer&);
+  void OnBufferedAmountChange(uint64_t bufferedAmount);
+
+  /**
+   * Stop relaying. The socket is closed once pending writes have flushed. Once
+   * this returns, the bridge no longer calls the RTCDataChannel.
+   */
+  void Stop();
+
+ private:
+  //
+  // These run on the network thread.
+  //
+  void Connect(const Target&);
+  void OnConnectEvent(rtc::AsyncSocket*);
+  void OnReadEvent(rtc::AsyncSocket*);
+  void OnWriteEvent(rtc::AsyncSocket*);
+  void OnCloseEvent(rtc::AsyncSocket*, int error);
+  void Read();
+  void Write();
+  void Close(const std::string& error);
+
+  //
+  // These run on the signaling thread.
+  //
+  void SendToChannel(const rtc::CopyOnWriteBuffer&);
+  void MaybeResumeReading();
+  void Closed(const std::string& error);
+
+  // NOTE: The RTCDataChannel clears _channel (via Stop) when it closes
+  // or is destroyed, so take _channel_mutex for as long as you use it. The
+  // mutex is recursive, since calling the RTCDataChannel may close it.
+  std::recursive_mutex _channel_mutex;
+  RTCDataChannel* _channel;
+  rtc::Thread* _signalingThread;
+  rtc::Thread* _networkThread;
+  uint64_t _high_water_mark;
+  // NOTE: Bytes read from the socket but not yet handed to the
+  // RTCDataChannel, plus the RTCDataChannel's own buffered amount, are what
+  // we hold reading against.
+  std::atomic<uint64_t> _unsubmitted = {0};
+  std::atomic<uint64_t> _buffered_amount = {0};
+  std::atomic<bool> _read_paused = {false};
+  // NOTE: The socket must be destroyed on the network thread, so while
+  // we have one, we keep ourselves alive until Close has destroyed it there.
+  std::unique_ptr<rtc::AsyncSocket> _socket;
+  rtc::scoped_refptr<DataChannelBridge> _self;
+  // NOTE: The caller's file descriptor, duplicated, and its original file
+  // status flags, which the socket server changes and Close restores.
+  int _fd = -1;
+  int _fd_flags = -1;
+  bool _connected = false;
+  bool _closing = false;
+  bool _closed = false;
+  std::deque<rtc::CopyOnWriteBuffer> _writes;
+  size_t _queued_write_bytes = 0;
+  size_t _write_offset = 0;
+};
+
+}  // namespace node_webrtc
@@ -109,27 +109,70 @@ RTCPeerConnection::~RTCPeerConnection() {
 }
 
 void RTCPeerConnection::OnSignalingChange(webrtc::PeerConnectionInterface::SignalingState state) {
-  Dispatch(CreateCallback<RTCPeerConnection>([this, state]() {
-    MakeCallback("onsignalingstatechange", {});
-    if (state == webrtc::PeerConnectionInterface::kClosed) {
-      Stop();
-    }
-  }));
+  _signaling_state = state;
+  DispatchStateChange(kSignalingStateChanged);
 }
 
 void RTCPeerConnection::OnIceConnectionChange(webrtc::PeerConnectionInterface::IceConnectionState) {
-  Dispatch(CreateCallback<RTCPeerConnection>([this]() {
-    MakeCallback("oniceconnectionstatechange", {});
-    MakeCallback("onconnectionstatechange", {});
-  }));
+  // NOTE: We report the standardized RTCIceConnectionState instead;
+  // see OnStandardizedIceConnectionChange.
+}
+
+void RTCPeerConnection::OnStandardizedIceConnectionChange(webrtc::PeerConnectionInterface::IceConnectionState state) {
+  _ice_connection_state = state;
+  DispatchStateChange(kIceConnectionStateChanged);
+}
+
+void RTCPeerConnection::OnConnectionChange(webrtc::PeerConnectionInterface::PeerConnectionState state) {
+  _connection_state = state;
+  DispatchStateChange(kConnectionStateChanged);
+}
+
+void RTCPeerConnection::OnIceGatheringChange(webrtc::PeerConnectionInterface::IceGatheringState state) {
+  _ice_gathering_state = state;
+  DispatchStateChange(kIceGatheringStateChanged);
 }
 
-void RTCPeerConnection::OnIceGatheringChange(webrtc::PeerConnectionInterface::IceGatheringState) {
+void RTCPeerConnection::DispatchStateChange(uint32_t changed) {
+  // NOTE: Coalesce state change Events, not states. At most one is
+  // pending at a time; it raises a handler for every state that changed since
+  // the last one, even if the state has since changed back, and passes the
+  // state as it is when the Event runs.
+  if (_changed_states.fetch_or(changed)) {
+    return;
+  }
   Dispatch(CreateCallback<RTCPeerConnection>([this]() {
-    MakeCallback("onicegatheringstatechange", {});
+    HandleStateChange(_changed_states.exchange(0));
   }));
 }
 
+void RTCPeerConnection::HandleStateChange(uint32_t changed) {
+  auto env = Env();
+  Napi::HandleScope scope(env);
+  // NOTE: Never return early, so that we always reach Stop() below.
+  auto dispatch = [this, env](const char* handler, auto state) {
+    auto maybeState = From<Napi::Value>(std::make_pair(env, state));
+    if (maybeState.IsValid()) {
+      MakeCallback(handler, { maybeState.UnsafeFromValid() });
+    }
+  };
+  if (changed & kSignalingStateChanged) {
+    dispatch("onsignalingstatechange", _signaling_state.load());
+  }
+  if (changed & kIceGatheringStateChanged) {
+    dispatch("onicegatheringstatechange", _ice_gathering_state.load());
+  }
+  if (changed & kIceConnectionStateChanged) {
+    dispatch("oniceconnectionstatechange", _ice_connection_state.load());
+  }
+  if (changed & kConnectionStateChanged) {
+    dispatch("onconnectionstatechange", _connection_state.load());
+  }
+  if (_signaling_state == webrtc::PeerConnectionInterface::kClosed) {
+    Stop();
+  }
+}
+
 void RTCPeerConnection::OnIceCandidate(const webrtc::IceCandidateInterface* ice_candidate) {
   std::string error;
 
@@ -625,7 +668,7 @@ Napi::Value RTCPeerConnection::GetConnectionState(const Napi::CallbackInfo& info
   auto env = info.Env();
 
   auto connectionState = _jinglePeerConnection
-      ? _jinglePeerConnection->peer_connection_state()
+      ? _connection_state.load()
       : webrtc::PeerConnectionInterface::PeerConnectionState::kClosed;
 
   CONVERT_OR_THROW_AND_RETURN_NAPI(env, connectionState, result, Napi::Value)
@@ -700,7 +743,7 @@ Napi::Value RTCPeerConnection::GetSctp(const Napi::CallbackInfo& info) {
 
 Napi::Value RTCPeerConnection::GetSignalingState(const Napi::CallbackInfo& info) {
   auto signalingState = _jinglePeerConnection
-      ? _jinglePeerConnection->signaling_state()
+      ? _signaling_state.load()
       : webrtc::PeerConnectionInterface::SignalingState ::kClosed;
   CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), signalingState, result, Napi::Value)
   return result;
@@ -708,7 +751,7 @@ Napi::Value RTCPeerConnection::GetSignalingState(const Napi::CallbackInfo& info)
 
 Napi::Value RTCPeerConnection::GetIceConnectionState(const Napi::CallbackInfo& info) {
   auto iceConnectionState = _jinglePeerConnection
-      ? _jinglePeerConnection->standardized_ice_connection_state()
+      ? _ice_connection_state.load()
       : webrtc::PeerConnectionInterface::IceConnectionState::kIceConnectionClosed;
   CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), iceConnectionState, result, Napi::Value)
   return result;
@@ -716,7 +759,7 @@ Napi::Value RTCPeerConnection::GetIceConnectionState(const Napi::CallbackInfo& i
 
 Napi::Value RTCPeerConnection::GetIceGatheringState(const Napi::CallbackInfo& info) {
   auto iceGatheringState = _jinglePeerConnection
-      ? _jinglePeerConnection->ice_gathering_state()
+      ? _ice_gathering_state.load()
       : webrtc::PeerConnectionInterface::IceGatheringState::kIceGatheringComplete;
   CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), iceGatheringState, result, Napi::Value)
   return result;
@@ -758,7 +801,16 @@ void RTCPeerConnection::Init(Napi::Env env, Napi::Object exports) {
     InstanceAccessor("sctp", &RTCPeerConnection::GetSctp, nullptr),
     InstanceAccessor("signalingState", &RTCPeerConnection::GetSignalingState, nullptr),
     InstanceAccessor("iceConnectionState", &RTCPeerConnection::GetIceConnectionState, nullptr),
-    InstanceAccessor("iceGatheringState", &RTCPeerConnection::GetIceGatheringState, nullptr)
+    InstanceAccessor("iceGatheringState", &RTCPeerConnection::GetIceGatheringState, nullptr),
+    CallbackProperty("onconnectionstatechange"),
+    CallbackProperty("ondatachannel"),
+    CallbackProperty("onicecandidate"),
+    CallbackProperty("onicecandidateerror"),
+    CallbackProperty("oniceconnectionstatechange"),
+    CallbackProperty("onicegatheringstatechange"),
+    CallbackProperty("onnegotiationneeded"),
+    CallbackProperty("onsignalingstatechange"),
+    CallbackProperty("ontrack")
   });
 
   constructor() = Napi::Persistent(func);
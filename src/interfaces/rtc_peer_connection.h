@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 #include <node-addon-api/napi.h>
@@ -45,6 +46,8 @@ class RTCPeerConnection
   //
   void OnSignalingChange(webrtc::PeerConnectionInterface::SignalingState new_state) override;
   void OnIceConnectionChange(webrtc::PeerConnectionInterface::IceConnectionState new_state) override;
+  void OnStandardizedIceConnectionChange(webrtc::PeerConnectionInterface::IceConnectionState new_state) override;
+  void OnConnectionChange(webrtc::PeerConnectionInterface::PeerConnectionState new_state) override;
   void OnIceGatheringChange(webrtc::PeerConnectionInterface::IceGatheringState new_state) override;
   void OnIceCandidate(const webrtc::IceCandidateInterface* candidate) override;
   void OnIceCandidateError(const std::string& host_candidate, const std::string& url, int error_code, const std::string& error_text) override;
@@ -106,8 +109,27 @@ class RTCPeerConnection
   Napi::Value GetSignalingState(const Napi::CallbackInfo&);
   Napi::Value GetIceGatheringState(const Napi::CallbackInfo&);
 
+  /**
+   * Bits for DispatchStateChange, one per state.
+   */
+  static constexpr uint32_t kSignalingStateChanged = 1 << 0;
+  static constexpr uint32_t kIceGatheringStateChanged = 1 << 1;
+  static constexpr uint32_t kIceConnectionStateChanged = 1 << 2;
+  static constexpr uint32_t kConnectionStateChanged = 1 << 3;
+
+  void DispatchStateChange(uint32_t changed);
+  void HandleStateChange(uint32_t changed);
+
   RTCSessionDescriptionInit _lastSdp;
 
+  // NOTE: These are written on the signaling thread, as libwebrtc
+  // reports state changes, and the getters read them without blocking on it.
+  std::atomic<webrtc::PeerConnectionInterface::SignalingState> _signaling_state = {webrtc::PeerConnectionInterface::kStable};
+  std::atomic<webrtc::PeerConnectionInterface::IceGatheringState> _ice_gathering_state = {webrtc::PeerConnectionInterface::kIceGatheringNew};
+  std::atomic<webrtc::PeerConnectionInterface::IceConnectionState> _ice_connection_state = {webrtc::PeerConnectionInterface::kIceConnectionNew};
+  std::atomic<webrtc::PeerConnectionInterface::PeerConnectionState> _connection_state = {webrtc::PeerConnectionInterface::PeerConnectionState::kNew};
+  std::atomic<uint32_t> _changed_states = {0};
+
   UnsignedShortRange _port_range;
   ExtendedRTCConfiguration _cached_configuration;
   rtc::scoped_refptr<webrtc::PeerConnectionInterface> _jinglePeerConnection;
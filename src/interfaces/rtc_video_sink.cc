@@ -7,21 +7,41 @@
  */
 #include "src/interfaces/rtc_video_sink.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
+#include <libyuv.h>
+#include <webrtc/api/video/i420_buffer.h>
+#include <webrtc/api/video/video_frame.h>
+#include <webrtc/api/video/video_frame_buffer.h>
 #include <webrtc/api/video/video_source_interface.h>
 
 #include "src/converters.h"
 #include "src/converters/arguments.h"
 #include "src/converters/napi.h"
-#include "src/dictionaries/webrtc/video_frame.h"  // IWYU pragma: keep
+#include "src/converters/object.h"
+#include "src/dictionaries/node_webrtc/rtc_video_sink_init.h"
+#include "src/dictionaries/node_webrtc/rtc_video_sink_wants.h"
+#include "src/enums/node_webrtc/overflow_policy.h"
+#include "src/functional/curry.h"
+#include "src/functional/maybe.h"
+#include "src/functional/operators.h"
 #include "src/functional/validation.h"
 #include "src/interfaces/media_stream_track.h"  // IWYU pragma: keep
+#include "src/node/error_factory.h"
 #include "src/node/events.h"
 
 namespace node_webrtc {
 
+constexpr double RTCVideoSink::kMinFramesPerSecond;
+
 Napi::FunctionReference& RTCVideoSink::constructor() {
   static Napi::FunctionReference constructor;
   return constructor;
@@ -33,12 +53,55 @@ RTCVideoSink::RTCVideoSink(const Napi::CallbackInfo& info)
     Napi::TypeError::New(info.Env(), "Use the new operator to construct an RTCVideoSink.").ThrowAsJavaScriptException();
     return;
   }
-  CONVERT_ARGS_OR_THROW_AND_RETURN_VOID_NAPI(info, track, rtc::scoped_refptr<webrtc::VideoTrackInterface>)
-
-  _track = std::move(track);
+  CONVERT_ARGS_OR_THROW_AND_RETURN_VOID_NAPI(info, args, std::tuple<rtc::scoped_refptr<webrtc::VideoTrackInterface> COMMA Maybe<RTCVideoSinkInit>>)
 
+  auto maybeInit = std::get<1>(args);
   rtc::VideoSinkWants wants;
+  if (maybeInit.IsJust()) {
+    auto init = maybeInit.UnsafeFromJust();
+    _zero_copy = init.zeroCopy;
+    _dispatch_frames = init.dispatchFrames;
+    _retain_latest_frame = !_dispatch_frames;
+    _format = init.format;
+    _width = init.width.FromMaybe(0);
+    _height = init.height.FromMaybe(0);
+    // NOTE: The interval must fit in an int64_t, so rates below
+    // kMinFramesPerSecond are treated as kMinFramesPerSecond.
+    _frame_interval_us = init.maxFramesPerSecond
+        .Map([](double fps) { return static_cast<int64_t>(std::llround(1000000 / std::max(fps, kMinFramesPerSecond))); })
+        .FromMaybe(static_cast<int64_t>(0));
+    if (init.latestFrameOnly) {
+      SetQueueLimit(1, OverflowPolicy::kCoalesce);
+    }
+
+    // NOTE: RTCVideoSinkInit also carries the RTCVideoSinkWants
+    // members.
+    auto maybeWants = From<rtc::VideoSinkWants>(info[1]);
+    if (maybeWants.IsInvalid()) {
+      Napi::TypeError::New(info.Env(), maybeWants.ToErrors()[0]).ThrowAsJavaScriptException();
+      return;
+    }
+    wants = maybeWants.UnsafeFromValid();
+  }
+
+  _track = std::get<0>(args);
+  _track->AddOrUpdateSink(this, wants);
+}
+
+Napi::Value RTCVideoSink::UpdateWants(const Napi::CallbackInfo& info) {
+  auto env = info.Env();
+  CONVERT_ARGS_OR_THROW_AND_RETURN_NAPI(info, wants, rtc::VideoSinkWants)
+  if (!_track) {
+    Napi::Error(env, ErrorFactory::CreateInvalidStateError(env, "RTCVideoSink is stopped")).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  // NOTE: Adding a sink that is already added updates its wants.
   _track->AddOrUpdateSink(this, wants);
+  return env.Undefined();
+}
+
+Napi::Value RTCVideoSink::GetSkippedFrames(const Napi::CallbackInfo& info) {
+  return Napi::Number::New(info.Env(), static_cast<double>(_skipped_frames.load(std::memory_order_relaxed)));
 }
 
 Napi::Value RTCVideoSink::GetStopped(const Napi::CallbackInfo& info) {
@@ -47,12 +110,16 @@ Napi::Value RTCVideoSink::GetStopped(const Napi::CallbackInfo& info) {
 }
 
 void RTCVideoSink::Stop() {
+  // NOTE: Stop the EventLoop first, so that a callback blocked on a
+  // full queue gives up instead of holding RemoveSink up.
+  AsyncObjectWrapWithLoop<RTCVideoSink>::Stop();
   if (_track) {
     _stopped = true;
     _track->RemoveSink(this);
     _track = nullptr;
   }
-  AsyncObjectWrapWithLoop<RTCVideoSink>::Stop();
+  std::lock_guard<std::mutex> lock(_latest_frame_mutex);
+  _latest_frame.reset();
 }
 
 Napi::Value RTCVideoSink::JsStop(const Napi::CallbackInfo& info) {
@@ -60,11 +127,327 @@ Napi::Value RTCVideoSink::JsStop(const Napi::CallbackInfo& info) {
   return info.Env().Undefined();
 }
 
-void RTCVideoSink::OnFrame(const webrtc::VideoFrame& frame) {
-  Dispatch(CreateCallback<RTCVideoSink>([this, frame]() {
+namespace {
+
+/**
+ * Where each plane of a frame starts, and how long its rows are.
+ */
+struct PlaneLayout {
+  size_t count = 0;
+  size_t offsets[3] = {};
+  int strides[3] = {};
+  size_t byteLength = 0;
+};
+
+/**
+ * A frame, converted and ready for JavaScript. Either it references an I420
+ * buffer, or it owns its bytes; either way, it lives as long as the
+ * ArrayBuffer that views it.
+ */
+struct ConvertedFrame {
+  int width = 0;
+  int height = 0;
+  webrtc::VideoRotation rotation = webrtc::kVideoRotation_0;
+  rtc::scoped_refptr<webrtc::I420BufferInterface> buffer;
+  std::unique_ptr<uint8_t[]> bytes;
+  const uint8_t* data = nullptr;
+  PlaneLayout layout;
+};
+
+/**
+ * A caller-provided buffer to read a frame into.
+ */
+struct FrameTarget {
+  uint32_t width;
+  uint32_t height;
+  Napi::Value data;
+  RTCVideoFrameFormat format;
+};
+
+}  // namespace
+
+static FrameTarget CreateFrameTarget(
+    const uint32_t width,
+    const uint32_t height,
+    const Napi::Value data,
+    const RTCVideoFrameFormat format) {
+  return {width, height, data, format};
+}
+
+static Validation<FrameTarget> GetFrameTarget(const Napi::Value value) {
+  return From<Napi::Object>(value).FlatMap<FrameTarget>([](auto object) {
+    return curry(CreateFrameTarget)
+        % GetRequired<uint32_t>(object, "width")
+        * GetRequired<uint32_t>(object, "height")
+        * GetRequired<Napi::Value>(object, "data")
+        * GetOptional<RTCVideoFrameFormat>(object, "format", RTCVideoFrameFormat::kI420);
+  });
+}
+
+/**
+ * Get the packed layout of a width x height frame in the given format.
+ */
+static PlaneLayout GetPackedLayout(RTCVideoFrameFormat format, int width, int height) {
+  auto chromaWidth = (width + 1) / 2;
+  auto chromaSize = static_cast<size_t>(chromaWidth) * ((height + 1) / 2);
+  PlaneLayout layout;
+  switch (format) {
+    case RTCVideoFrameFormat::kI420:
+      layout.count = 3;
+      layout.offsets[1] = static_cast<size_t>(width) * height;
+      layout.offsets[2] = layout.offsets[1] + chromaSize;
+      layout.strides[0] = width;
+      layout.strides[1] = chromaWidth;
+      layout.strides[2] = chromaWidth;
+      layout.byteLength = layout.offsets[2] + chromaSize;
+      break;
+    case RTCVideoFrameFormat::kNv12:
+      layout.count = 2;
+      layout.offsets[1] = static_cast<size_t>(width) * height;
+      layout.strides[0] = width;
+      layout.strides[1] = chromaWidth * 2;
+      layout.byteLength = layout.offsets[1] + chromaSize * 2;
+      break;
+    case RTCVideoFrameFormat::kRgba:
+      layout.count = 1;
+      layout.strides[0] = width * 4;
+      layout.byteLength = static_cast<size_t>(layout.strides[0]) * height;
+      break;
+  }
+  return layout;
+}
+
+/**
+ * Write an I420 buffer into a destination with the given packed layout (see
+ * GetPackedLayout), converting it to the given format.
+ */
+static void WritePacked(
+    const webrtc::I420BufferInterface& buffer,
+    RTCVideoFrameFormat format,
+    const PlaneLayout& layout,
+    uint8_t* destination) {
+  switch (format) {
+    case RTCVideoFrameFormat::kI420:
+      libyuv::I420Copy(
+          buffer.DataY(), buffer.StrideY(),
+          buffer.DataU(), buffer.StrideU(),
+          buffer.DataV(), buffer.StrideV(),
+          destination, layout.strides[0],
+          destination + layout.offsets[1], layout.strides[1],
+          destination + layout.offsets[2], layout.strides[2],
+          buffer.width(), buffer.height());
+      break;
+    case RTCVideoFrameFormat::kNv12:
+      libyuv::I420ToNV12(
+          buffer.DataY(), buffer.StrideY(),
+          buffer.DataU(), buffer.StrideU(),
+          buffer.DataV(), buffer.StrideV(),
+          destination, layout.strides[0],
+          destination + layout.offsets[1], layout.strides[1],
+          buffer.width(), buffer.height());
+      break;
+    case RTCVideoFrameFormat::kRgba:
+      libyuv::I420ToABGR(
+          buffer.DataY(), buffer.StrideY(),
+          buffer.DataU(), buffer.StrideU(),
+          buffer.DataV(), buffer.StrideV(),
+          destination, layout.strides[0],
+          buffer.width(), buffer.height());
+      break;
+  }
+}
+
+/**
+ * Scale an I420 buffer, unless it is already the given size.
+ */
+static rtc::scoped_refptr<webrtc::I420BufferInterface> ScaleI420(
+    rtc::scoped_refptr<webrtc::I420BufferInterface> buffer,
+    int width,
+    int height) {
+  if (width == buffer->width() && height == buffer->height()) {
+    return buffer;
+  }
+  auto scaled = webrtc::I420Buffer::Create(width, height);
+  scaled->ScaleFrom(*buffer);
+  return scaled;
+}
+
+static std::unique_ptr<ConvertedFrame> Pack(
+    const webrtc::I420BufferInterface& buffer,
+    RTCVideoFrameFormat format,
+    std::unique_ptr<ConvertedFrame> frame) {
+  frame->layout = GetPackedLayout(format, buffer.width(), buffer.height());
+  frame->bytes.reset(new uint8_t[frame->layout.byteLength]);
+  WritePacked(buffer, format, frame->layout, frame->bytes.get());
+  frame->data = frame->bytes.get();
+  return frame;
+}
+
+/**
+ * Share an I420 buffer's planes as they are, reporting each plane's offset and
+ * stride instead of repacking them.
+ */
+static std::unique_ptr<ConvertedFrame> Share(
+    const rtc::scoped_refptr<webrtc::I420BufferInterface>& buffer,
+    std::unique_ptr<ConvertedFrame> frame) {
+  auto chromaHeight = static_cast<size_t>(buffer->ChromaHeight());
+  auto begin = buffer->DataY();
+  auto& layout = frame->layout;
+  layout.count = 3;
+  layout.strides[0] = buffer->StrideY();
+  layout.strides[1] = buffer->StrideU();
+  layout.strides[2] = buffer->StrideV();
+  layout.offsets[1] = static_cast<size_t>(layout.strides[0]) * buffer->height();
+  layout.offsets[2] = layout.offsets[1] + static_cast<size_t>(layout.strides[1]) * chromaHeight;
+
+  // NOTE: webrtc::I420Buffer (and anything else that allocates the
+  // planes back to back) lays them out Y, U, V with no gaps. Any other layout
+  // could span unrelated memory, so those frames are packed into a copy.
+  if (buffer->DataU() != begin + layout.offsets[1] || buffer->DataV() != begin + layout.offsets[2]) {
+    return Pack(*buffer, RTCVideoFrameFormat::kI420, std::move(frame));
+  }
+
+  layout.byteLength = layout.offsets[2] + static_cast<size_t>(layout.strides[2]) * chromaHeight;
+  frame->buffer = buffer;
+  frame->data = begin;
+  return frame;
+}
+
+/**
+ * Scale and convert a frame, per an RTCVideoSink's RTCVideoSinkInit. This runs
+ * on whichever libwebrtc thread delivered the frame.
+ */
+static std::unique_ptr<ConvertedFrame> ConvertFrame(
+    const webrtc::VideoFrame& videoFrame,
+    RTCVideoFrameFormat format,
+    uint32_t targetWidth,
+    uint32_t targetHeight,
+    bool zeroCopy) {
+  // NOTE: ToI420 returns the buffer itself if it is already I420;
+  // otherwise, it converts here, on libwebrtc's thread, rather than on the
+  // JavaScript thread.
+  auto original = videoFrame.video_frame_buffer();
+  auto buffer = original->ToI420();
+
+  // NOTE: If only one of width and height is given, the other
+  // follows the frame's aspect ratio.
+  auto width = static_cast<int>(targetWidth);
+  auto height = static_cast<int>(targetHeight);
+  if (!width && !height) {
+    width = buffer->width();
+    height = buffer->height();
+  } else if (!height) {
+    height = std::max(1, static_cast<int>(std::lround(static_cast<double>(width) * buffer->height() / buffer->width())));
+  } else if (!width) {
+    width = std::max(1, static_cast<int>(std::lround(static_cast<double>(height) * buffer->width() / buffer->height())));
+  }
+
+  std::unique_ptr<ConvertedFrame> frame(new ConvertedFrame());
+  frame->width = width;
+  frame->height = height;
+  frame->rotation = videoFrame.rotation();
+
+  auto scaled = width != buffer->width() || height != buffer->height();
+  auto converted = static_cast<webrtc::VideoFrameBuffer*>(buffer.get()) != original.get();
+  buffer = ScaleI420(buffer, width, height);
+
+  // NOTE: JavaScript can write to the ArrayBuffer, so only share a buffer that
+  // no one else has: one we scaled, or one ToI420 converted for us. libwebrtc's
+  // own buffer is shared with every other consumer of the track (other sinks,
+  // encoders), so it is always copied.
+  return format == RTCVideoFrameFormat::kI420 && (scaled || (zeroCopy && converted))
+      ? Share(buffer, std::move(frame))
+      : Pack(*buffer, format, std::move(frame));
+}
+
+/**
+ * Create an RTCVideoFrame from a ConvertedFrame. Its data is an ArrayBuffer
+ * which views the ConvertedFrame and keeps it alive until garbage collected.
+ */
+static Validation<Napi::Value> CreateFrame(Napi::Env env, std::unique_ptr<ConvertedFrame> frame) {
+  auto owner = frame.release();
+  auto byteLength = owner->layout.byteLength;
+  // NOTE: ConvertFrame only shares buffers that no one else has, so
+  // JavaScript may write to them.
+  auto arrayBuffer = Napi::ArrayBuffer::New(env, const_cast<uint8_t*>(owner->data), byteLength, [](Napi::Env env, void*, ConvertedFrame* owner) {
+    int64_t adjusted;
+    napi_adjust_external_memory(env, -static_cast<int64_t>(owner->layout.byteLength), &adjusted);
+    delete owner;
+  }, owner);
+  if (env.IsExceptionPending()) {
+    delete owner;
+    return Validation<Napi::Value>::Invalid(env.GetAndClearPendingException().Message());
+  }
+  // NOTE: V8 cannot see the memory these frames hold, so tell it; that
+  // way it collects them, and libwebrtc gets its buffers back, promptly.
+  int64_t adjusted;
+  napi_adjust_external_memory(env, static_cast<int64_t>(byteLength), &adjusted);
+
+  auto& layout = owner->layout;
+  auto planes = Napi::Array::New(env, layout.count);
+  for (uint32_t i = 0; i < layout.count; i++) {
+    auto plane = Napi::Object::New(env);
+    plane.Set("offset", Napi::Number::New(env, static_cast<double>(layout.offsets[i])));
+    plane.Set("stride", Napi::Number::New(env, layout.strides[i]));
+    planes.Set(i, plane);
+  }
+
+  // FIXME(mroberts): How to create a Uint8ClampedArray?
+  auto object = Napi::Object::New(env);
+  object.Set("width", Napi::Number::New(env, owner->width));
+  object.Set("height", Napi::Number::New(env, owner->height));
+  object.Set("rotation", Napi::Number::New(env, static_cast<int>(owner->rotation)));
+  object.Set("data", Napi::Uint8Array::New(env, byteLength, arrayBuffer, 0));
+  object.Set("planes", planes);
+  return Pure<Napi::Value>(object);
+}
+
+bool RTCVideoSink::ShouldSkipFrame() {
+  if (!_frame_interval_us) {
+    return false;
+  }
+  auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  // NOTE: Accept a frame up to half an interval early, so that
+  // jitter in the source does not skip frames we ought to deliver. Schedule
+  // from the last deadline rather than from now, so the average rate holds;
+  // but start over after a gap, rather than delivering a burst to catch up.
+  if (now < _next_frame_us - _frame_interval_us / 2) {
+    return true;
+  }
+  _next_frame_us = now > _next_frame_us + _frame_interval_us
+      ? now + _frame_interval_us
+      : _next_frame_us + _frame_interval_us;
+  return false;
+}
+
+void RTCVideoSink::OnFrame(const webrtc::VideoFrame& videoFrame) {
+  // NOTE: Holding onto the latest frame only costs a reference, but it keeps
+  // the frame's buffer alive, so only do so if readLatestFrame might want it.
+  if (_retain_latest_frame.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(_latest_frame_mutex);
+    _latest_frame = videoFrame;
+  }
+  if (!_dispatch_frames) {
+    return;
+  }
+  // NOTE: Skip frames before converting or queueing them, so that
+  // they cost nothing but this check.
+  if (ShouldSkipFrame()) {
+    _skipped_frames.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  // NOTE: Converting is the expensive part, so under "drop-newest",
+  // drop a frame the queue has no room for before converting it.
+  if (WouldDropBounded()) {
+    DidDropEvent();
+    return;
+  }
+  auto frame = ConvertFrame(videoFrame, _format, _width, _height, _zero_copy);
+  DispatchBounded(CreateCallback<RTCVideoSink>([this, frame = std::move(frame)]() mutable {
     auto env = Env();
     Napi::HandleScope scope(env);
-    auto maybeValue = From<Napi::Value>(std::make_pair(env, frame));
+    auto maybeValue = CreateFrame(env, std::move(frame));
     if (maybeValue.IsInvalid()) {
       // TODO(mroberts): Should raise an error; although this really shouldn't happen.
       return;
@@ -76,10 +459,81 @@ void RTCVideoSink::OnFrame(const webrtc::VideoFrame& frame) {
   }));
 }
 
+Napi::Value RTCVideoSink::ReadLatestFrame(const Napi::CallbackInfo& info) {
+  auto env = info.Env();
+  auto maybeTarget = GetFrameTarget(info[0]);
+  if (maybeTarget.IsInvalid()) {
+    Napi::TypeError::New(env, maybeTarget.ToErrors()[0]).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  auto target = maybeTarget.UnsafeFromValid();
+  if (!target.data.IsTypedArray()) {
+    Napi::TypeError::New(env, "Expected .data to be a TypedArray").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  auto isValid = [](uint32_t dimension) { return dimension > 0 && dimension <= 16384; };
+  if (!isValid(target.width) || !isValid(target.height)) {
+    Napi::TypeError::New(env, "Expected width and height to be between 1 and 16384").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  auto width = static_cast<int>(target.width);
+  auto height = static_cast<int>(target.height);
+  auto layout = GetPackedLayout(target.format, width, height);
+  auto data = target.data.As<Napi::TypedArray>();
+  if (data.ByteLength() != layout.byteLength) {
+    auto error = "Expected a .byteLength of " + std::to_string(layout.byteLength) + ", not " +
+        std::to_string(data.ByteLength());
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  _retain_latest_frame.store(true, std::memory_order_relaxed);
+  absl::optional<webrtc::VideoFrame> videoFrame;
+  {
+    std::lock_guard<std::mutex> lock(_latest_frame_mutex);
+    videoFrame = _latest_frame;
+  }
+  if (!videoFrame) {
+    return env.Null();
+  }
+
+  auto destination = static_cast<uint8_t*>(data.ArrayBuffer().Data()) + data.ByteOffset();
+  auto buffer = videoFrame->video_frame_buffer()->ToI420();
+  if (target.format == RTCVideoFrameFormat::kI420 && (width != buffer->width() || height != buffer->height())) {
+    // NOTE: Scale straight into the target, rather than into an
+    // intermediate buffer.
+    libyuv::I420Scale(
+        buffer->DataY(), buffer->StrideY(),
+        buffer->DataU(), buffer->StrideU(),
+        buffer->DataV(), buffer->StrideV(),
+        buffer->width(), buffer->height(),
+        destination, layout.strides[0],
+        destination + layout.offsets[1], layout.strides[1],
+        destination + layout.offsets[2], layout.strides[2],
+        width, height,
+        libyuv::kFilterBox);
+  } else {
+    WritePacked(*ScaleI420(buffer, width, height), target.format, layout, destination);
+  }
+
+  auto object = Napi::Object::New(env);
+  object.Set("width", Napi::Number::New(env, videoFrame->width()));
+  object.Set("height", Napi::Number::New(env, videoFrame->height()));
+  object.Set("rotation", Napi::Number::New(env, static_cast<int>(videoFrame->rotation())));
+  object.Set("timestamp", Napi::Number::New(env, videoFrame->timestamp_us() / 1000.0));
+  return object;
+}
+
 void RTCVideoSink::Init(Napi::Env env, Napi::Object exports) {
   auto func = DefineClass(env, "RTCVideoSink", {
+    CallbackProperty("dispatchEvent"),
+    InstanceAccessor("droppedEvents", &RTCVideoSink::GetDroppedEvents, nullptr),
+    InstanceAccessor("skippedFrames", &RTCVideoSink::GetSkippedFrames, nullptr),
     InstanceAccessor("stopped", &RTCVideoSink::GetStopped, nullptr),
-    InstanceMethod("stop", &RTCVideoSink::JsStop)
+    InstanceMethod("readLatestFrame", &RTCVideoSink::ReadLatestFrame),
+    InstanceMethod("setQueueLimit", &RTCVideoSink::JsSetQueueLimit),
+    InstanceMethod("stop", &RTCVideoSink::JsStop),
+    InstanceMethod("updateWants", &RTCVideoSink::UpdateWants)
   });
 
   constructor() = Napi::Persistent(func);
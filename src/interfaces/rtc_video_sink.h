@@ -7,15 +7,20 @@
  */
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include <absl/types/optional.h>
 #include <node-addon-api/napi.h>
 #include <webrtc/api/media_stream_interface.h>
 #include <webrtc/api/scoped_refptr.h>
+#include <webrtc/api/video/video_frame.h>
 #include <webrtc/api/video/video_sink_interface.h>
 
+#include "src/enums/node_webrtc/rtc_video_frame_format.h"
 #include "src/node/async_object_wrap_with_loop.h"
 
-namespace webrtc { class VideoFrame; }
-
 namespace node_webrtc {
 
 class RTCVideoSink
@@ -30,15 +35,40 @@ class RTCVideoSink
 
   static Napi::FunctionReference& constructor();
 
+  /**
+   * The lowest maxFramesPerSecond honored; lower rates are rounded up to it.
+   */
+  static constexpr double kMinFramesPerSecond = 0.001;
+
  protected:
   void Stop() override;
 
  private:
+  /**
+   * Whether maxFramesPerSecond rules out a frame arriving now. Only call this
+   * from OnFrame.
+   */
+  bool ShouldSkipFrame();
+
+  Napi::Value GetSkippedFrames(const Napi::CallbackInfo&);
   Napi::Value GetStopped(const Napi::CallbackInfo&);
 
   Napi::Value JsStop(const Napi::CallbackInfo&);
+  Napi::Value ReadLatestFrame(const Napi::CallbackInfo&);
+  Napi::Value UpdateWants(const Napi::CallbackInfo&);
 
   bool _stopped = false;
+  bool _zero_copy = false;
+  bool _dispatch_frames = true;
+  RTCVideoFrameFormat _format = RTCVideoFrameFormat::kI420;
+  uint32_t _width = 0;
+  uint32_t _height = 0;
+  int64_t _frame_interval_us = 0;
+  int64_t _next_frame_us = 0;
+  std::atomic<uint64_t> _skipped_frames = {0};
+  std::atomic<bool> _retain_latest_frame = {false};
+  std::mutex _latest_frame_mutex;
+  absl::optional<webrtc::VideoFrame> _latest_frame;
   rtc::scoped_refptr<webrtc::VideoTrackInterface> _track;
 };
 
@@ -25,6 +25,38 @@
 
 namespace node_webrtc {
 
+void RTCVideoTrackSource::PushFrame(const webrtc::VideoFrame& frame) {
+  if (!_adapt_frames) {
+    OnFrame(frame);
+    return;
+  }
+  // NOTE: AdaptFrame applies every sink's rtc::VideoSinkWants (for example, an
+  // RTCVideoSink's maxPixelCount and maxFramerate) so that frames nobody wants
+  // are dropped or scaled down here, once, instead of per sink. This includes
+  // RTCPeerConnection's encoders, which is why it is opt-in.
+  int adapted_width;
+  int adapted_height;
+  int crop_width;
+  int crop_height;
+  int crop_x;
+  int crop_y;
+  if (!AdaptFrame(frame.width(), frame.height(), frame.timestamp_us(),
+          &adapted_width, &adapted_height, &crop_width, &crop_height, &crop_x, &crop_y)) {
+    return;
+  }
+  if (adapted_width == frame.width() && adapted_height == frame.height()) {
+    OnFrame(frame);
+    return;
+  }
+  auto buffer = webrtc::I420Buffer::Create(adapted_width, adapted_height);
+  buffer->CropAndScaleFrom(*frame.video_frame_buffer()->ToI420(), crop_x, crop_y, crop_width, crop_height);
+  OnFrame(webrtc::VideoFrame::Builder()
+      .set_video_frame_buffer(buffer)
+      .set_timestamp_us(frame.timestamp_us())
+      .set_rotation(frame.rotation())
+      .build());
+}
+
 Napi::FunctionReference& RTCVideoSource::constructor() {
   static Napi::FunctionReference constructor;
   return constructor;
@@ -50,7 +82,7 @@ Napi::Value RTCVideoSource::New(const Napi::CallbackInfo& info) {
   .Map([](auto needsDenoising) { return absl::optional<bool>(needsDenoising); })
   .FromMaybe(absl::optional<bool>());
 
-  _source = new rtc::RefCountedObject<RTCVideoTrackSource>(init.isScreencast, needsDenoising);
+  _source = new rtc::RefCountedObject<RTCVideoTrackSource>(init.isScreencast, needsDenoising, init.adaptFrames);
 
   return info.Env().Undefined();
 }
@@ -82,6 +114,11 @@ Napi::Value RTCVideoSource::GetNeedsDenoising(const Napi::CallbackInfo& info) {
   return result;
 }
 
+Napi::Value RTCVideoSource::GetAdaptFrames(const Napi::CallbackInfo& info) {
+  CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), _source->adapt_frames(), result, Napi::Value)
+  return result;
+}
+
 Napi::Value RTCVideoSource::GetIsScreencast(const Napi::CallbackInfo& info) {
   CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), _source->is_screencast(), result, Napi::Value)
   return result;
@@ -93,6 +130,7 @@ void RTCVideoSource::Init(Napi::Env env, Napi::Object exports) {
   Napi::Function func = DefineClass(env, "RTCVideoSource", {
     InstanceMethod("createTrack", &RTCVideoSource::CreateTrack),
     InstanceMethod("onFrame", &RTCVideoSource::OnFrame),
+    InstanceAccessor("adaptFrames", &RTCVideoSource::GetAdaptFrames, nullptr),
     InstanceAccessor("needsDenoising", &RTCVideoSource::GetNeedsDenoising, nullptr),
     InstanceAccessor("isScreencast", &RTCVideoSource::GetIsScreencast, nullptr)
   });
@@ -27,8 +27,9 @@ class RTCVideoTrackSource : public rtc::AdaptedVideoTrackSource {
   RTCVideoTrackSource()
     : rtc::AdaptedVideoTrackSource(), _is_screencast(false) {}
 
-  RTCVideoTrackSource(const bool is_screencast, const absl::optional<bool> needs_denoising)
-    : rtc::AdaptedVideoTrackSource(), _is_screencast(is_screencast), _needs_denoising(needs_denoising) {}
+  RTCVideoTrackSource(const bool is_screencast, const absl::optional<bool> needs_denoising, const bool adapt_frames = false)
+    : rtc::AdaptedVideoTrackSource(), _is_screencast(is_screencast), _needs_denoising(needs_denoising),
+      _adapt_frames(adapt_frames) {}
 
   ~RTCVideoTrackSource() override {
     PeerConnectionFactory::Release();
@@ -51,14 +52,17 @@ class RTCVideoTrackSource : public rtc::AdaptedVideoTrackSource {
     return _needs_denoising;
   }
 
-  void PushFrame(const webrtc::VideoFrame& frame) {
-    this->OnFrame(frame);
+  bool adapt_frames() const {
+    return _adapt_frames;
   }
 
+  void PushFrame(const webrtc::VideoFrame& frame);
+
  private:
   PeerConnectionFactory* _factory = PeerConnectionFactory::GetOrCreateDefault();
   const bool _is_screencast;
   const absl::optional<bool> _needs_denoising;
+  const bool _adapt_frames = false;
 };
 
 class RTCVideoSource
@@ -73,6 +77,7 @@ class RTCVideoSource
 
   Napi::Value New(const Napi::CallbackInfo&);
 
+  Napi::Value GetAdaptFrames(const Napi::CallbackInfo&);
   Napi::Value GetIsScreencast(const Napi::CallbackInfo&);
   Napi::Value GetNeedsDenoising(const Napi::CallbackInfo&);
 
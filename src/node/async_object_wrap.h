@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <cstring>
 #include <initializer_list>
 #include <mutex>
+#include <vector>
 
 #include <node-addon-api/napi.h>
 
@@ -14,6 +17,9 @@ class AsyncObjectWrap: public Napi::ObjectWrap<T> {
  private:
   Napi::AsyncContext* _async_context;
   std::mutex _async_context_mutex;
+  std::vector<Napi::FunctionReference> _callbacks;
+  std::vector<bool> _assigned_callbacks;
+  bool _callbacks_released = false;
 
   void DestroyAsyncContext() {
     _async_context_mutex.lock();
@@ -24,6 +30,83 @@ class AsyncObjectWrap: public Napi::ObjectWrap<T> {
     _async_context_mutex.unlock();
   }
 
+  static std::vector<const char*>& callback_names() {
+    static std::vector<const char*> names;
+    return names;
+  }
+
+  static size_t CallbackIndex(const char* name) {
+    auto& names = callback_names();
+    for (size_t i = 0; i < names.size(); i++) {
+      if (names[i] == name || !std::strcmp(names[i], name)) {
+        return i;
+      }
+    }
+    return names.size();
+  }
+
+  Napi::FunctionReference& CallbackReference(size_t index) {
+    if (_callbacks.size() <= index) {
+      _callbacks.resize(callback_names().size());
+      _assigned_callbacks.resize(callback_names().size());
+    }
+    return _callbacks[index];
+  }
+
+  /**
+   * Hold a callback in a data property on the object itself, which shadows
+   * the accessor and which the garbage collector can see.
+   */
+  void StoreCallback(size_t index, const Napi::Value& value) {
+    auto env = this->Env();
+    this->Value().DefineProperty(Napi::PropertyDescriptor::Value(
+            callback_names()[index],
+            value.IsFunction() ? value : env.Null(),
+            static_cast<napi_property_attributes>(napi_writable | napi_enumerable | napi_configurable)));
+  }
+
+  Napi::Value Callback(size_t index) {
+    auto env = this->Env();
+    auto& reference = CallbackReference(index);
+    if (!reference.IsEmpty()) {
+      auto callback = reference.Value();
+      if (!callback.IsEmpty()) {
+        return callback;
+      }
+    }
+    // NOTE: Until the callback is assigned, it is whatever the
+    // prototype we inherit from has, for example EventTarget's dispatchEvent.
+    napi_value prototype;
+    if (napi_get_prototype(env, T::constructor().Value().Get("prototype"), &prototype) != napi_ok) {
+      return env.Undefined();
+    }
+    auto callback = Napi::Object(env, prototype).Get(callback_names()[index]);
+    if (callback.IsFunction() && !_callbacks_released) {
+      reference = Napi::Persistent(callback.As<Napi::Function>());
+    }
+    return callback;
+  }
+
+  Napi::Value GetCallback(const Napi::CallbackInfo& info) {
+    auto callback = Callback(reinterpret_cast<size_t>(info.Data()));
+    return callback.IsFunction() ? callback : info.Env().Null();
+  }
+
+  void SetCallback(const Napi::CallbackInfo& info, const Napi::Value& value) {
+    auto index = reinterpret_cast<size_t>(info.Data());
+    if (_callbacks_released) {
+      StoreCallback(index, value);
+      return;
+    }
+    auto& reference = CallbackReference(index);
+    _assigned_callbacks[index] = value.IsFunction();
+    if (!value.IsFunction()) {
+      reference.Reset();
+    } else {
+      reference = Napi::Persistent(value.As<Napi::Function>());
+    }
+  }
+
  public:
   AsyncObjectWrap(
       const char* name,
@@ -42,9 +125,54 @@ class AsyncObjectWrap: public Napi::ObjectWrap<T> {
   }
 
  protected:
+  /**
+   * Define a property holding a callback, such as "onicecandidate" or
+   * "dispatchEvent". MakeCallback calls it through a reference cached on the
+   * wrapper instead of looking it up for every Event, and assigning the
+   * property replaces the cached reference.
+   * @param name the property name, which must be a string literal
+   * @return the property descriptor
+   */
+  static Napi::ClassPropertyDescriptor<T> CallbackProperty(const char* name) {
+    auto index = CallbackIndex(name);
+    if (index == callback_names().size()) {
+      callback_names().push_back(name);
+    }
+    return Napi::ObjectWrap<T>::InstanceAccessor(
+            name,
+            static_cast<typename Napi::ObjectWrap<T>::InstanceGetterCallback>(&AsyncObjectWrap<T>::GetCallback),
+            static_cast<typename Napi::ObjectWrap<T>::InstanceSetterCallback>(&AsyncObjectWrap<T>::SetCallback),
+            napi_default,
+            reinterpret_cast<void*>(index));
+  }
+
+  /**
+   * Release the callbacks cached on the wrapper. The cached references are
+   * strong, so a wrapper must release them once it will make no more
+   * callbacks, or else the callbacks and the wrapper keep each other alive.
+   * Assigned callbacks move onto the object itself, so they still read back.
+   */
+  void ReleaseCallbacks() {
+    if (_callbacks_released) {
+      return;
+    }
+    _callbacks_released = true;
+    Napi::HandleScope scope(this->Env());
+    for (size_t i = 0; i < _callbacks.size(); i++) {
+      if (_assigned_callbacks[i] && !_callbacks[i].IsEmpty()) {
+        StoreCallback(i, _callbacks[i].Value());
+      }
+    }
+    _callbacks.clear();
+    _assigned_callbacks.clear();
+  }
+
   void MakeCallback(const char* name, const std::initializer_list<napi_value>& args) {
     auto self = this->Value();
-    auto maybeFunction = self.Get(name);
+    auto index = CallbackIndex(name);
+    auto maybeFunction = index < callback_names().size() && !_callbacks_released
+        ? Callback(index)
+        : self.Get(name);
     if (maybeFunction.IsFunction()) {
       _async_context_mutex.lock();
       if (_async_context) {
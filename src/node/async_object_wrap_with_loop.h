@@ -5,8 +5,12 @@
 
 #include <node-addon-api/napi.h>
 
+#include "src/converters/arguments.h"
+#include "src/converters/napi.h"
+#include "src/dictionaries/node_webrtc/event_queue_limit.h"
 #include "src/node/async_object_wrap.h"
 #include "src/node/event_loop.h"
+#include "src/node/event_metrics.h"
 
 namespace node_webrtc {
 
@@ -20,7 +24,7 @@ class AsyncObjectWrapWithLoop
       T& target,
       const Napi::CallbackInfo& info) :
     AsyncObjectWrap<T>(name, info),
-    EventLoop<T>(info.Env(), this->context(), target) {
+    EventLoop<T>(info.Env(), this->context(), target, EventMetrics::For(name)) {
     this->Ref();
   }
 
@@ -29,8 +33,25 @@ class AsyncObjectWrapWithLoop
    * This method will be invoked once the AsyncObjectWrapWithLoop stops.
    */
   void DidStop() override {
+    this->ReleaseCallbacks();
     this->Unref();
   }
+
+  /**
+   * Implements the nonstandard `setQueueLimit(limit)` method.
+   */
+  Napi::Value JsSetQueueLimit(const Napi::CallbackInfo& info) {
+    CONVERT_ARGS_OR_THROW_AND_RETURN_NAPI(info, limit, EventQueueLimit)
+    this->SetQueueLimit(limit.capacity, limit.policy);
+    return info.Env().Undefined();
+  }
+
+  /**
+   * Implements the nonstandard `droppedEvents` attribute.
+   */
+  Napi::Value GetDroppedEvents(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), this->dropped_events());
+  }
 };
 
 }  // namespace node_webrtc
@@ -0,0 +1,193 @@
+/* Copyright (c) 2019 The node-webrtc project authors. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found
+ * in the LICENSE.md file in the root of the source tree. All contributing
+ * project authors may be found in the AUTHORS file in the root of the source
+ * tree.
+ */
+#include "src/node/event_dispatcher.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "src/converters.h"
+#include "src/converters/napi.h"  // IWYU pragma: keep
+#include "src/node/event_pool.h"
+
+namespace node_webrtc {
+
+// NOTE: The budget applies to every EventDispatcher. The defaults
+// bound each wake to roughly a frame's worth of time, and let each object
+// dispatch a handful of Events before the next one gets a turn.
+static std::atomic<size_t> max_events = {0};
+static std::atomic<size_t> max_events_per_turn = {64};
+static std::atomic<int64_t> max_time_us = {10000};
+static std::atomic<bool> batching_callbacks = {false};
+
+static std::atomic<uint64_t> wakeups = {0};
+static std::atomic<uint64_t> events_dispatched = {0};
+static std::atomic<uint64_t> budget_exhausted = {0};
+static std::atomic<uint64_t> preemptions = {0};
+static std::atomic<uint64_t> max_events_per_wakeup = {0};
+
+// NOTE: There is one EventDispatcher per Napi::Env (that is, per
+// JavaScript thread). The map itself is only touched when EventLoops are
+// created and stopped, never when Events are dispatched.
+static std::mutex& mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+static std::unordered_map<napi_env, EventDispatcher*>& dispatchers() {
+  static std::unordered_map<napi_env, EventDispatcher*> dispatchers;
+  return dispatchers;
+}
+
+EventDispatcher::EventDispatcher(napi_env env, uv_loop_t* loop): _env(env) {
+  uv_async_init(loop, &_async, [](auto handle) {
+    auto self = static_cast<EventDispatcher*>(handle->data);
+    self->Run();
+  });
+  _async.data = this;
+}
+
+EventDispatcher* EventDispatcher::Acquire(Napi::Env env) {
+  std::lock_guard<std::mutex> lock(mutex());
+  auto it = dispatchers().find(env);
+  if (it != dispatchers().end()) {
+    it->second->_references++;
+    return it->second;
+  }
+
+  uv_loop_t* loop;
+  auto status = napi_get_uv_event_loop(env, &loop);
+  {
+    using Napi::Error;
+    NAPI_THROW_IF_FAILED(env, status, nullptr);
+  }
+
+  auto dispatcher = new EventDispatcher(env, loop);
+  dispatcher->_references++;
+  dispatchers()[env] = dispatcher;
+  return dispatcher;
+}
+
+void EventDispatcher::Release() {
+  std::lock_guard<std::mutex> lock(mutex());
+  if (--_references) {
+    return;
+  }
+  dispatchers().erase(_env);
+  uv_close(reinterpret_cast<uv_handle_t*>(&_async), [](auto handle) {
+    delete static_cast<EventDispatcher*>(handle->data);
+  });
+}
+
+void EventDispatcher::Schedule(Schedulable* schedulable, EventPriority priority) {
+  auto i = static_cast<size_t>(priority);
+  _lanes[i].Push(&schedulable->_entries[i]);
+  uv_async_send(&_async);
+}
+
+void EventDispatcher::DidPreempt() {
+  preemptions.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool EventDispatcher::batch_callbacks() {
+  return batching_callbacks.load(std::memory_order_relaxed);
+}
+
+void EventDispatcher::Run() {
+  EventBudget budget(
+      max_events.load(std::memory_order_relaxed),
+      max_events_per_turn.load(std::memory_order_relaxed),
+      std::chrono::microseconds(max_time_us.load(std::memory_order_relaxed)));
+  wakeups.fetch_add(1, std::memory_order_relaxed);
+  while (auto entry = Next()) {
+    if (budget.exhausted()) {
+      // NOTE: We cannot put the entry back at the front of its lane,
+      // so hold onto it until the next wake.
+      _held[static_cast<size_t>(entry->_priority)] = entry;
+      budget_exhausted.fetch_add(1, std::memory_order_relaxed);
+      uv_async_send(&_async);
+      break;
+    }
+    entry->_schedulable->RunScheduled(budget, entry->_priority);
+    budget.NextTurn();
+  }
+  events_dispatched.fetch_add(budget.events(), std::memory_order_relaxed);
+  if (budget.events() > max_events_per_wakeup.load(std::memory_order_relaxed)) {
+    max_events_per_wakeup.store(budget.events(), std::memory_order_relaxed);
+  }
+}
+
+Schedulable::Entry* EventDispatcher::Next() {
+  for (size_t i = 0; i < kEventPriorities; i++) {
+    if (auto entry = _held[i]) {
+      _held[i] = nullptr;
+      return entry;
+    }
+    if (auto entry = _lanes[i].Pop()) {
+      return entry;
+    }
+  }
+  return nullptr;
+}
+
+void EventDispatcher::Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("getEventLoopStats", Napi::Function::New(env, GetEventLoopStats));
+  exports.Set("setEventLoopBudget", Napi::Function::New(env, SetEventLoopBudget));
+}
+
+Napi::Value EventDispatcher::GetEventLoopStats(const Napi::CallbackInfo& info) {
+  auto env = info.Env();
+  auto stats = Napi::Object::New(env);
+  stats.Set("wakeups", Napi::Number::New(env, wakeups.load(std::memory_order_relaxed)));
+  stats.Set("eventsDispatched", Napi::Number::New(env, events_dispatched.load(std::memory_order_relaxed)));
+  stats.Set("budgetExhausted", Napi::Number::New(env, budget_exhausted.load(std::memory_order_relaxed)));
+  stats.Set("preemptions", Napi::Number::New(env, preemptions.load(std::memory_order_relaxed)));
+  stats.Set("maxEventsPerWakeup", Napi::Number::New(env, max_events_per_wakeup.load(std::memory_order_relaxed)));
+  stats.Set("eventAllocations", Napi::Number::New(env, EventPool::allocations()));
+  return stats;
+}
+
+Napi::Value EventDispatcher::SetEventLoopBudget(const Napi::CallbackInfo& info) {
+  auto env = info.Env();
+  if (!info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected an object").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  auto object = info[0].As<Napi::Object>();
+
+  auto maybeMaxEvents = object.Has("maxEvents")
+      ? From<uint32_t>(object.Get("maxEvents"))
+      : Pure(static_cast<uint32_t>(max_events));
+  auto maybeMaxEventsPerObject = object.Has("maxEventsPerObject")
+      ? From<uint32_t>(object.Get("maxEventsPerObject"))
+      : Pure(static_cast<uint32_t>(max_events_per_turn));
+  auto maybeBatchCallbacks = object.Has("batchCallbacks")
+      ? From<bool>(object.Get("batchCallbacks"))
+      : Pure(batch_callbacks());
+  auto maybeMaxTime = object.Has("maxTime")
+      ? From<double>(object.Get("maxTime"))
+      : Pure(max_time_us / 1000.0);
+  if (maybeMaxEvents.IsInvalid() || maybeMaxEventsPerObject.IsInvalid() || maybeMaxTime.IsInvalid()
+      || !std::isfinite(maybeMaxTime.UnsafeFromValid()) || maybeMaxTime.UnsafeFromValid() < 0) {
+    Napi::TypeError::New(env, "Expected maxEvents, maxEventsPerObject and maxTime to be non-negative numbers").ThrowAsJavaScriptException();
+    return env.Undefined();
+  } else if (maybeBatchCallbacks.IsInvalid()) {
+    Napi::TypeError::New(env, "Expected batchCallbacks to be a boolean").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  max_events = maybeMaxEvents.UnsafeFromValid();
+  max_events_per_turn = maybeMaxEventsPerObject.UnsafeFromValid();
+  max_time_us = static_cast<int64_t>(maybeMaxTime.UnsafeFromValid() * 1000);
+  batching_callbacks = maybeBatchCallbacks.UnsafeFromValid();
+  return env.Undefined();
+}
+
+}  // namespace node_webrtc
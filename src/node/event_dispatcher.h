@@ -0,0 +1,207 @@
+/* Copyright (c) 2019 The node-webrtc project authors. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found
+ * in the LICENSE.md file in the root of the source tree. All contributing
+ * project authors may be found in the AUTHORS file in the root of the source
+ * tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+#include <node-addon-api/napi.h>
+#include <uv.h>
+
+#include "src/node/events.h"
+#include "src/node/mpsc_queue.h"
+
+namespace node_webrtc {
+
+class EventDispatcher;
+
+/**
+ * An EventBudget bounds the work an EventDispatcher does each time it wakes,
+ * so that a burst of Events cannot hold the JavaScript thread away from
+ * timers, I/O and other objects. Each wake may dispatch a limited number of
+ * Events, for a limited time; each turn (one Schedulable, run once) may
+ * dispatch a limited number of Events. A limit of zero means no limit. At
+ * least one Event is always dispatched per wake, so work always progresses.
+ */
+class EventBudget {
+ public:
+  EventBudget(size_t max_events, size_t max_events_per_turn, std::chrono::microseconds max_time)
+    : _max_events(max_events)
+    , _max_events_per_turn(max_events_per_turn)
+    , _max_time(max_time)
+    , _start(std::chrono::steady_clock::now()) {}
+
+  /**
+   * Whether another Event may be dispatched in this turn.
+   * @return true if another Event may be dispatched
+   */
+  bool available() const {
+    return (!_max_events_per_turn || _turn_events < _max_events_per_turn) && !exhausted();
+  }
+
+  /**
+   * Whether this wake has used up its budget.
+   * @return true if the budget is exhausted
+   */
+  bool exhausted() const {
+    if (_max_events && _events >= _max_events) {
+      return true;
+    }
+    return _max_time.count() && _events && std::chrono::steady_clock::now() - _start >= _max_time;
+  }
+
+  /**
+   * Get the number of Events dispatched in this wake.
+   * @return the number of Events
+   */
+  size_t events() const {
+    return _events;
+  }
+
+  /**
+   * Record that an Event was dispatched.
+   */
+  void Spend() {
+    _events++;
+    _turn_events++;
+  }
+
+  /**
+   * Start the next turn.
+   */
+  void NextTurn() {
+    _turn_events = 0;
+  }
+
+ private:
+  const size_t _max_events;
+  const size_t _max_events_per_turn;
+  const std::chrono::microseconds _max_time;
+  const std::chrono::steady_clock::time_point _start;
+  size_t _events = 0;
+  size_t _turn_events = 0;
+};
+
+/**
+ * A Schedulable is something an EventDispatcher can run on the JavaScript
+ * thread, namely an EventLoop. A Schedulable can be scheduled once in each
+ * EventPriority's lane at a time.
+ */
+class Schedulable {
+  friend class EventDispatcher;
+
+ public:
+  Schedulable() {
+    for (size_t i = 0; i < kEventPriorities; i++) {
+      _entries[i]._schedulable = this;
+      _entries[i]._priority = static_cast<EventPriority>(i);
+    }
+  }
+
+  Schedulable(const Schedulable&) = delete;
+  Schedulable& operator=(const Schedulable&) = delete;
+
+  virtual ~Schedulable() = default;
+
+ protected:
+  /**
+   * This method is invoked on the JavaScript thread each time the Schedulable
+   * reaches the front of one of its EventDispatcher's lanes. A Schedulable
+   * with more work than its budget allows should Schedule itself again.
+   * @param budget the EventBudget for this turn
+   * @param priority the lane the Schedulable was scheduled in
+   */
+  virtual void RunScheduled(EventBudget& budget, EventPriority priority) = 0;
+
+ private:
+  class Entry: public MpscNode {
+    friend class EventDispatcher;
+    friend class Schedulable;
+
+    Schedulable* _schedulable;
+    EventPriority _priority;
+  };
+
+  Entry _entries[kEventPriorities];
+};
+
+/**
+ * An EventDispatcher wakes the JavaScript thread for every EventLoop in a
+ * Napi::Env with one shared uv_async_t, instead of one per EventLoop. EventLoops
+ * with pending Events Schedule themselves, and the EventDispatcher runs each
+ * of them in turn when it wakes.
+ *
+ * EventDispatchers are reference-counted by their EventLoops. The uv_async_t
+ * exists (and keeps the process alive) exactly as long as there is an
+ * EventLoop which has not stopped, just like the per-EventLoop uv_async_ts it
+ * replaces.
+ *
+ * Each wake runs Schedulables round-robin under an EventBudget, emptying the
+ * control lane before taking each turn from the bulk lane. Work left over when
+ * the budget runs out waits for the next wake, after libuv has had a chance to
+ * run timers and I/O.
+ */
+class EventDispatcher {
+ public:
+  static void Init(Napi::Env, Napi::Object);
+
+  /**
+   * Get or create the EventDispatcher for a Napi::Env, and take a reference to
+   * it. Call this on the JavaScript thread. If the EventDispatcher cannot be
+   * created, this throws and returns nullptr.
+   * @param env the Napi::Env
+   * @return the EventDispatcher or nullptr
+   */
+  static EventDispatcher* Acquire(Napi::Env env);
+
+  /**
+   * Release a reference to the EventDispatcher. Call this on the JavaScript
+   * thread.
+   */
+  void Release();
+
+  /**
+   * Schedule a Schedulable to run on the JavaScript thread. This can be called
+   * from any thread. A Schedulable must not be scheduled again in the same
+   * lane until it runs.
+   * @param schedulable the Schedulable
+   * @param priority the lane to schedule the Schedulable in
+   */
+  void Schedule(Schedulable* schedulable, EventPriority priority);
+
+  /**
+   * Record that a Schedulable stopped with work left over because its turn
+   * ran out.
+   */
+  static void DidPreempt();
+
+  /**
+   * Whether to dispatch each turn's Events inside one CallbackScope instead of
+   * one CallbackScope per Event.
+   * @return true if batching callbacks
+   */
+  static bool batch_callbacks();
+
+ private:
+  EventDispatcher(napi_env env, uv_loop_t* loop);
+
+  static Napi::Value GetEventLoopStats(const Napi::CallbackInfo&);
+  static Napi::Value SetEventLoopBudget(const Napi::CallbackInfo&);
+
+  void Run();
+
+  Schedulable::Entry* Next();
+
+  napi_env _env;
+  uv_async_t _async{};
+  MpscQueue<Schedulable::Entry> _lanes[kEventPriorities];
+  Schedulable::Entry* _held[kEventPriorities] = {};
+  size_t _references = 0;
+};
+
+}  // namespace node_webrtc
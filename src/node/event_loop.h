@@ -1,88 +1,425 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <thread>
 
 #include <node-addon-api/napi.h>
-#include <uv.h>
 
+#include "src/enums/node_webrtc/overflow_policy.h"
+#include "src/node/event_dispatcher.h"
+#include "src/node/event_metrics.h"
 #include "src/node/event_queue.h"
 #include "src/node/events.h"
 
 namespace node_webrtc {
 
+/**
+ * An EventLoop dispatches Events to a target on the JavaScript thread. Events
+ * can be dispatched from any thread; the EventLoop schedules itself with its
+ * Napi::Env's EventDispatcher, which runs it on the JavaScript thread.
+ * @tparam T the Event target type
+ */
 template <typename T>
-class EventLoop: private EventQueue<T> {
+class EventLoop: private EventQueue<T>, private Schedulable {
  public:
-  virtual ~EventLoop() = default;
+  virtual ~EventLoop() {
+    while (auto event = this->Dequeue()) {
+      if (event->counted()) {
+        _metrics->DidDiscard();
+      }
+    }
+    for (size_t i = 0; i < _bounded.size(); i++) {
+      _metrics->DidDiscard();
+    }
+  }
+
+  /**
+   * Dispatch an Event to the target. This can be called from any thread.
+   * @param event the Event to dispatch
+   * @param priority the lane to dispatch the Event in
+   */
+  void Dispatch(std::unique_ptr<Event<T>> event, EventPriority priority = EventPriority::kControl) {
+    event->set_enqueued_at(EventMetrics::Now());
+    _metrics->DidEnqueue();
+    Post(std::move(event), priority);
+  }
 
-  void Dispatch(std::unique_ptr<Event<T>> event) {
-    this->Enqueue(std::move(event));
-    _lock.lock();
-    if (!uv_is_closing(reinterpret_cast<uv_handle_t*>(&_async))) {
-      uv_async_send(&_async);
+  /**
+   * Dispatch an Event in the bulk lane, subject to the EventLoop's queue limit
+   * (see SetQueueLimit). Use this for Events that can pile up while the
+   * JavaScript thread is busy, such as media frames. This can be called from
+   * any thread.
+   * @param event the Event to dispatch
+   */
+  void DispatchBounded(std::unique_ptr<Event<T>> event) {
+    if (!_limited) {
+      Dispatch(std::move(event), EventPriority::kBulk);
+      return;
+    }
+    // NOTE: Count the Event now, even though it waits in _bounded, so that
+    // metrics and queue depth see it and its latency includes the wait.
+    event->set_enqueued_at(EventMetrics::Now());
+    _metrics->DidEnqueue();
+    this->Hold();
+    // NOTE: Events we drop are destroyed after unlocking, since
+    // destroying one may release a frame or a buffer.
+    std::unique_ptr<Event<T>> dropped;
+    auto schedule = false;
+    {
+      std::unique_lock<std::mutex> lock(_bounded_mutex);
+      if (full()) {
+        switch (_policy) {
+          case OverflowPolicy::kDropNewest:
+            dropped = std::move(event);
+            break;
+          case OverflowPolicy::kDropOldest:
+          case OverflowPolicy::kCoalesce:
+            dropped = std::move(_bounded.front());
+            _bounded.pop_front();
+            break;
+          case OverflowPolicy::kBlock:
+            // NOTE: Blocking the JavaScript thread would deadlock,
+            // since it is the thread that makes room. Other threads wait a
+            // bounded time, because the JavaScript thread may itself be
+            // waiting on them (for example, in a synchronous call into
+            // libwebrtc); then they give up and drop the Event.
+            if (std::this_thread::get_id() != _thread) {
+              _bounded_space.wait_for(lock, kMaxBlock, [this]() {
+                return !full() || _should_stop;
+              });
+              if (full() && !_should_stop) {
+                dropped = std::move(event);
+              }
+            }
+            break;
+        }
+      }
+      if (event) {
+        _bounded.push_back(std::move(event));
+        schedule = !_bounded_scheduled;
+        _bounded_scheduled = true;
+      }
+    }
+    if (dropped) {
+      this->Unhold();
+      _metrics->DidDiscard();
+      DidDropEvent();
+    }
+    if (schedule) {
+      PostNextBounded();
     }
-    _lock.unlock();
   }
 
-  bool should_stop() const {
-    return _should_stop;
+  /**
+   * Check whether DispatchBounded would drop an Event dispatched now, because
+   * the queue is full and the policy is OverflowPolicy::kDropNewest. Check
+   * this before preparing an expensive Event; by the time you dispatch, the
+   * answer may have changed. This can be called from any thread.
+   * @return true if the Event would be dropped
+   */
+  bool WouldDropBounded() {
+    if (!_limited) {
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(_bounded_mutex);
+    return _policy == OverflowPolicy::kDropNewest && full();
   }
 
- protected:
-  EventLoop(Napi::Env env, Napi::AsyncContext* context, T& target): _context(context), _env(env), _target(target) {
-    uv_loop_t* loop;
-    auto status = napi_get_uv_event_loop(_env, &loop);
+  /**
+   * Limit the number of Events dispatched with DispatchBounded that may wait
+   * at once. Call this on the JavaScript thread.
+   * @param capacity the limit, or zero for no limit
+   * @param policy what to do with an Event that would exceed the limit
+   */
+  void SetQueueLimit(size_t capacity, OverflowPolicy policy) {
     {
-      using Napi::Error;
-      NAPI_THROW_IF_FAILED_VOID(_env, status);
+      std::lock_guard<std::mutex> lock(_bounded_mutex);
+      _capacity = capacity;
+      _policy = policy;
     }
+    // NOTE: Once limited, always go through _bounded, so that Events
+    // dispatched after removing the limit never overtake those still waiting.
+    _limited = true;
+    _bounded_space.notify_all();
+  }
 
-    uv_async_init(loop, &_async, [](auto handle) {
-      auto self = static_cast<EventLoop<T>*>(handle->data);
-      self->Run();
-    });
+  /**
+   * Get the queue limit set with SetQueueLimit, for subclasses that hold
+   * Events of their own. This can be called from any thread.
+   * @param policy set to the OverflowPolicy, if there is a limit
+   * @return the number of Events that may wait at once, or zero for no limit
+   */
+  size_t queue_limit(OverflowPolicy* policy) {
+    if (!_limited) {
+      return 0;
+    }
+    std::lock_guard<std::mutex> lock(_bounded_mutex);
+    *policy = _policy;
+    return _policy == OverflowPolicy::kCoalesce ? 1 : _capacity;
+  }
 
-    _async.data = this;
+  /**
+   * Get the number of Events dropped because of the queue limit.
+   * @return the number of Events
+   */
+  uint64_t dropped_events() const {
+    return _dropped.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * The longest DispatchBounded blocks under OverflowPolicy::kBlock.
+   */
+  static constexpr std::chrono::milliseconds kMaxBlock{100};
+
+  bool should_stop() const {
+    return _should_stop;
+  }
+
+  /**
+   * Get the number of Events waiting to be dispatched.
+   * @return the number of Events
+   */
+  size_t queue_depth() const {
+    return this->size();
+  }
+
+  /**
+   * Get the largest number of Events ever waiting to be dispatched at once.
+   * @return the number of Events
+   */
+  size_t peak_queue_depth() const {
+    return this->peak_size();
+  }
+
+ protected:
+  EventLoop(Napi::Env env, Napi::AsyncContext* context, T& target, EventMetrics* metrics)
+    : _context(context)
+    , _env(env)
+    , _metrics(metrics)
+    , _target(target)
+    , _thread(std::this_thread::get_id()) {
+    _dispatcher = EventDispatcher::Acquire(env);
+    if (!_dispatcher) {
+      _closing = true;
+    }
   }
 
   virtual void DidStop() {
     // Do nothing.
   }
 
-  virtual void Run() {
+  /**
+   * Count an Event dropped before it could be dispatched, for example by a
+   * subclass's own limit. This can be called from any thread.
+   */
+  void DidDropEvent() {
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+    _metrics->DidDrop();
+  }
+
+  virtual void Run(EventBudget& budget, EventPriority priority) {
     Napi::HandleScope scope(_env);
+    // NOTE: Opening and closing a CallbackScope runs async_hooks and,
+    // for the outermost scope, a microtask checkpoint. In batchCallbacks mode we
+    // pay that cost once per turn instead of once per Event.
+    auto batch = EventDispatcher::batch_callbacks();
+    napi_callback_scope batchScope = nullptr;
+    auto preempted = false;
     if (!_should_stop) {
-      while (auto event = this->Dequeue()) {
-        Napi::CallbackScope callbackScope(_env, *_context);
-        event->Dispatch(_target);
+      _metrics->DidWake();
+      while (true) {
+        if (!budget.available()) {
+          // NOTE: Only yield our place in line if there is something left to
+          // dispatch. Otherwise this turn simply ended.
+          preempted = !this->empty(EventPriority::kControl)
+              || (priority == EventPriority::kBulk && !this->empty(EventPriority::kBulk));
+          break;
+        }
+        // NOTE: A turn in the control lane only dispatches control
+        // Events; a turn in the bulk lane dispatches control Events first.
+        auto event = priority == EventPriority::kControl
+            ? this->Dequeue(EventPriority::kControl)
+            : this->Dequeue();
+        if (!event) {
+          break;
+        }
+        if (event->counted()) {
+          _metrics->DidDispatch(event->enqueued_at());
+        }
+        if (batch && !batchScope &&
+            napi_open_callback_scope(_env, Napi::Object::New(_env), *_context, &batchScope) != napi_ok) {
+          // NOTE: If we cannot open a CallbackScope for the batch, fall back to
+          // one per Event, as if batchCallbacks were off.
+          batch = false;
+          batchScope = nullptr;
+        }
+        if (batch) {
+          event->Dispatch(_target);
+          ReportPendingException();
+        } else {
+          Napi::CallbackScope callbackScope(_env, *_context);
+          event->Dispatch(_target);
+        }
+        budget.Spend();
         if (_should_stop) {
           break;
         }
       }
     }
-    if (_should_stop) {
-      _lock.lock();
-      uv_close(reinterpret_cast<uv_handle_t*>(&_async), [](auto handle) {
-        auto self = static_cast<EventLoop<T>*>(handle->data);
-        self->DidStop();
-      });
-      _lock.unlock();
+    // NOTE: Failing to close the scope we opened would leave async_hooks
+    // unbalanced, so treat it as fatal, just as Napi::CallbackScope does.
+    if (batchScope && napi_close_callback_scope(_env, batchScope) != napi_ok) {
+      Napi::Error::Fatal("EventLoop::Run", "napi_close_callback_scope failed");
+    }
+    if (_should_stop && !_closing.exchange(true)) {
+      while (_senders) {
+        std::this_thread::yield();
+      }
+      // NOTE: If a Dispatch scheduled us in another lane before
+      // _closing was set, we are still in the EventDispatcher's queue, so we
+      // finish stopping when it reaches us.
+      if (!any_scheduled()) {
+        Finish();
+      }
+    } else if (preempted) {
+      // NOTE: Go to the back of the line, so that every other object
+      // with pending Events gets a turn first.
+      EventDispatcher::DidPreempt();
+      if (!scheduled(priority).exchange(true)) {
+        _dispatcher->Schedule(this, priority);
+      }
     }
   }
 
   virtual void Stop() {
     _should_stop = true;
+    {
+      // NOTE: Take the lock so that a producer about to wait cannot
+      // miss the notification.
+      std::lock_guard<std::mutex> lock(_bounded_mutex);
+    }
+    _bounded_space.notify_all();
     Dispatch(Event<T>::Create());
   }
 
  private:
-  uv_async_t _async{};
+  void Post(std::unique_ptr<Event<T>> event, EventPriority priority) {
+    this->Enqueue(std::move(event), priority);
+    // NOTE: Rather than lock, we count the threads scheduling so that
+    // Run never finishes stopping underneath one of them.
+    _senders.fetch_add(1);
+    if (!_closing && !scheduled(priority).exchange(true)) {
+      _dispatcher->Schedule(this, priority);
+    }
+    _senders.fetch_sub(1);
+  }
+
+  /**
+   * Post the Event that dispatches the next Event waiting in _bounded. It holds
+   * the bounded Event's place in the bulk lane, but it is not counted itself.
+   */
+  void PostNextBounded() {
+    auto next = CreateCallback<T>([this]() {
+      DispatchNextBounded();
+    });
+    next->set_counted(false);
+    Post(std::move(next), EventPriority::kBulk);
+  }
+
+  void RunScheduled(EventBudget& budget, EventPriority priority) override {
+    scheduled(priority) = false;
+    if (_closing) {
+      if (!any_scheduled()) {
+        Finish();
+      }
+      return;
+    }
+    Run(budget, priority);
+  }
+
+  bool full() const {
+    auto capacity = _policy == OverflowPolicy::kCoalesce ? 1 : _capacity;
+    return capacity && _bounded.size() >= capacity;
+  }
+
+  void DispatchNextBounded() {
+    std::unique_ptr<Event<T>> event;
+    auto more = false;
+    {
+      std::lock_guard<std::mutex> lock(_bounded_mutex);
+      if (!_bounded.empty()) {
+        event = std::move(_bounded.front());
+        _bounded.pop_front();
+      }
+      more = !_bounded.empty();
+      _bounded_scheduled = more;
+    }
+    _bounded_space.notify_one();
+    if (more) {
+      PostNextBounded();
+    }
+    if (event) {
+      this->Unhold();
+      _metrics->DidDispatch(event->enqueued_at());
+      event->Dispatch(_target);
+    }
+  }
+
+  void ReportPendingException() {
+    // NOTE: An exception thrown by one Event's handler must not stop
+    // the rest of the batch, so report it as uncaught and carry on.
+    if (_env.IsExceptionPending()) {
+      napi_fatal_exception(_env, _env.GetAndClearPendingException().Value());
+    }
+  }
+
+  std::atomic<bool>& scheduled(EventPriority priority) {
+    return _scheduled[static_cast<size_t>(priority)];
+  }
+
+  bool any_scheduled() const {
+    for (auto& scheduled : _scheduled) {
+      if (scheduled) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Finish() {
+    auto dispatcher = _dispatcher;
+    DidStop();
+    dispatcher->Release();
+  }
+
+  EventDispatcher* _dispatcher;
   Napi::AsyncContext* _context;
   Napi::Env _env;
-  std::mutex _lock{};
+  EventMetrics* _metrics;
+  std::atomic<size_t> _senders = {0};
+  std::atomic<bool> _scheduled[kEventPriorities] = {};
+  std::atomic<bool> _closing = {false};
   std::atomic<bool> _should_stop = {false};
   T& _target;
+  const std::thread::id _thread;
+  std::atomic<bool> _limited = {false};
+  std::atomic<uint64_t> _dropped = {0};
+  std::mutex _bounded_mutex;
+  std::condition_variable _bounded_space;
+  std::deque<std::unique_ptr<Event<T>>> _bounded;
+  size_t _capacity = 0;
+  OverflowPolicy _policy = OverflowPolicy::kDropOldest;
+  bool _bounded_scheduled = false;
 };
 
+template <typename T>
+constexpr std::chrono::milliseconds EventLoop<T>::kMaxBlock;
+
 }  // namespace node_webrtc
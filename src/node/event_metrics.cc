@@ -0,0 +1,77 @@
+/* Copyright (c) 2019 The node-webrtc project authors. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found
+ * in the LICENSE.md file in the root of the source tree. All contributing
+ * project authors may be found in the AUTHORS file in the root of the source
+ * tree.
+ */
+#include "src/node/event_metrics.h"
+
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace node_webrtc {
+
+// NOTE: There are only ever a dozen or so classes, and we only look
+// them up when constructing objects, so a locked vector is plenty.
+static std::mutex& mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+static std::vector<EventMetrics*>& metrics() {
+  static auto metrics = new std::vector<EventMetrics*>();
+  return *metrics;
+}
+
+EventMetrics* EventMetrics::For(const char* name) {
+  std::lock_guard<std::mutex> lock(mutex());
+  for (auto existing : metrics()) {
+    if (existing->_name == name) {
+      return existing;
+    }
+  }
+  auto created = new EventMetrics(name);
+  metrics().push_back(created);
+  return created;
+}
+
+int64_t EventMetrics::Now() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void EventMetrics::Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("getEventMetrics", Napi::Function::New(env, GetEventMetrics));
+}
+
+Napi::Value EventMetrics::GetEventMetrics(const Napi::CallbackInfo& info) {
+  auto env = info.Env();
+  auto classes = Napi::Object::New(env);
+  std::lock_guard<std::mutex> lock(mutex());
+  for (auto existing : metrics()) {
+    auto histogram = Napi::Array::New(env, LatencyHistogram::kBuckets);
+    for (uint32_t i = 0; i < LatencyHistogram::kBuckets; i++) {
+      auto bucket = Napi::Object::New(env);
+      bucket.Set("lessThan", i + 1 < LatencyHistogram::kBuckets
+          ? Napi::Number::New(env, LatencyHistogram::UpperBound(i))
+          : Napi::Number::New(env, std::numeric_limits<double>::infinity()));
+      bucket.Set("count", Napi::Number::New(env, existing->_dispatch_latency.count(i)));
+      histogram.Set(i, bucket);
+    }
+    auto stats = Napi::Object::New(env);
+    stats.Set("eventsEnqueued", Napi::Number::New(env, existing->_enqueued.load(std::memory_order_relaxed)));
+    stats.Set("eventsDispatched", Napi::Number::New(env, existing->_dispatched.load(std::memory_order_relaxed)));
+    stats.Set("eventsDropped", Napi::Number::New(env, existing->_dropped.load(std::memory_order_relaxed)));
+    stats.Set("queueDepth", Napi::Number::New(env, existing->_depth.load(std::memory_order_relaxed)));
+    stats.Set("peakQueueDepth", Napi::Number::New(env, existing->_max_depth.load(std::memory_order_relaxed)));
+    stats.Set("wakeups", Napi::Number::New(env, existing->_wakeups.load(std::memory_order_relaxed)));
+    stats.Set("dispatchLatency", histogram);
+    classes.Set(existing->_name, stats);
+  }
+  return classes;
+}
+
+}  // namespace node_webrtc
@@ -0,0 +1,105 @@
+/* Copyright (c) 2019 The node-webrtc project authors. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found
+ * in the LICENSE.md file in the root of the source tree. All contributing
+ * project authors may be found in the AUTHORS file in the root of the source
+ * tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <node-addon-api/napi.h>
+
+#include "src/utilities/latency_histogram.h"
+
+namespace node_webrtc {
+
+/**
+ * EventMetrics count the Events passing through every EventLoop of one class,
+ * such as RTCDataChannel: how many were enqueued and dispatched, how many are
+ * waiting, how often the class was woken, and how long Events waited. Every
+ * update is a relaxed atomic operation, so they are always on.
+ */
+class EventMetrics {
+ public:
+  static void Init(Napi::Env, Napi::Object);
+
+  /**
+   * Get the EventMetrics for a class, creating them if necessary. Call this
+   * when constructing an EventLoop, not per Event. EventMetrics live as long
+   * as the process.
+   * @param name the class name
+   * @return the EventMetrics
+   */
+  static EventMetrics* For(const char* name);
+
+  /**
+   * Get the current time, for timestamping Events.
+   * @return a monotonic time in microseconds
+   */
+  static int64_t Now();
+
+  /**
+   * Record that an Event was enqueued. This can be called from any thread.
+   */
+  void DidEnqueue() {
+    _enqueued.fetch_add(1, std::memory_order_relaxed);
+    auto depth = _depth.fetch_add(1, std::memory_order_relaxed) + 1;
+    auto max_depth = _max_depth.load(std::memory_order_relaxed);
+    while (depth > max_depth && !_max_depth.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed)) {
+      // Do nothing.
+    }
+  }
+
+  /**
+   * Record that an Event was dequeued and is about to be dispatched.
+   * @param enqueued_at when the Event was enqueued, per Now()
+   */
+  void DidDispatch(int64_t enqueued_at) {
+    _dispatched.fetch_add(1, std::memory_order_relaxed);
+    _depth.fetch_sub(1, std::memory_order_relaxed);
+    _dispatch_latency.Record(Now() - enqueued_at);
+  }
+
+  /**
+   * Record that an Event was dropped because its queue was full. This can be
+   * called from any thread.
+   */
+  void DidDrop() {
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Record that an Event was discarded without being dispatched.
+   */
+  void DidDiscard() {
+    _depth.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Record that an EventLoop of this class was woken to dispatch Events.
+   */
+  void DidWake() {
+    _wakeups.fetch_add(1, std::memory_order_relaxed);
+  }
+
+ private:
+  explicit EventMetrics(const char* name): _name(name) {}
+
+  static Napi::Value GetEventMetrics(const Napi::CallbackInfo&);
+
+  const std::string _name;
+  std::atomic<uint64_t> _enqueued = {0};
+  std::atomic<uint64_t> _dispatched = {0};
+  std::atomic<uint64_t> _wakeups = {0};
+  std::atomic<uint64_t> _dropped = {0};
+  std::atomic<size_t> _depth = {0};
+  std::atomic<size_t> _max_depth = {0};
+  LatencyHistogram _dispatch_latency;
+};
+
+}  // namespace node_webrtc
@@ -0,0 +1,155 @@
+/* Copyright (c) 2019 The node-webrtc project authors. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found
+ * in the LICENSE.md file in the root of the source tree. All contributing
+ * project authors may be found in the AUTHORS file in the root of the source
+ * tree.
+ */
+#include "src/node/event_pool.h"
+
+#include <atomic>
+#include <new>
+
+namespace node_webrtc {
+
+// NOTE: Blocks are rounded up to a multiple of kGranularity bytes. Events
+// larger than kMaxSize are rare, so they just use the heap.
+static constexpr size_t kGranularity = 16;
+static constexpr size_t kMaxSize = 512;
+static constexpr size_t kSizeClasses = kMaxSize / kGranularity;
+static constexpr size_t kMaxFreeBlocks = 1024;
+
+namespace {
+
+struct Block {
+  Block* next;
+};
+
+/**
+ * A lock-free stack of released blocks. Any thread may push a single block,
+ * but blocks are only ever taken all at once, so there is no ABA problem.
+ */
+struct ReturnStack {
+  std::atomic<Block*> head = {nullptr};
+  std::atomic<size_t> size = {0};
+};
+
+/**
+ * The blocks a thread can acquire without synchronizing with other threads, at
+ * most EventPool::kMaxCachedBlocks per size class.
+ */
+struct ThreadCache {
+  struct List {
+    Block* head = nullptr;
+  };
+
+  List lists[kSizeClasses];
+
+  ~ThreadCache() {
+    for (auto& list : lists) {
+      while (auto block = list.head) {
+        list.head = block->next;
+        ::operator delete(block);
+      }
+    }
+  }
+};
+
+}  // namespace
+
+static std::atomic<uint64_t> heap_allocations = {0};
+
+static size_t size_class(size_t size) {
+  return size && size <= kMaxSize ? (size - 1) / kGranularity : kSizeClasses;
+}
+
+static ReturnStack& return_stack(size_t size_class) {
+  // NOTE: This is deliberately leaked, so that Events destroyed during static
+  // destruction still have somewhere to go.
+  static auto return_stacks = new ReturnStack[kSizeClasses];
+  return return_stacks[size_class];
+}
+
+/**
+ * Push a list of blocks onto a ReturnStack. The caller accounts for its size.
+ */
+static void Push(ReturnStack& stack, Block* head) {
+  auto tail = head;
+  while (tail->next) {
+    tail = tail->next;
+  }
+  tail->next = stack.head.load(std::memory_order_relaxed);
+  while (!stack.head.compare_exchange_weak(tail->next, head,
+          std::memory_order_release, std::memory_order_relaxed)) {
+  }
+}
+
+static ThreadCache::List& thread_cache(size_t size_class) {
+  static thread_local ThreadCache cache;
+  return cache.lists[size_class];
+}
+
+void* EventPool::Acquire(size_t size) {
+  auto index = size_class(size);
+  if (index == kSizeClasses) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+  }
+  auto& list = thread_cache(index);
+  if (!list.head) {
+    // NOTE: Events are usually created on one thread and destroyed on another,
+    // so refill from everything that has been released since the last time.
+    auto& stack = return_stack(index);
+    if (stack.head.load(std::memory_order_relaxed)) {
+      list.head = stack.head.exchange(nullptr, std::memory_order_acquire);
+      // NOTE: Keep at most kMaxCachedBlocks and push the rest back, so
+      // that a thread which stops creating Events strands few blocks.
+      size_t taken = 0;
+      Block* last = nullptr;
+      for (auto block = list.head; block && taken < kMaxCachedBlocks; block = block->next) {
+        last = block;
+        taken++;
+      }
+      stack.size.fetch_sub(taken, std::memory_order_relaxed);
+      if (last && last->next) {
+        auto rest = last->next;
+        last->next = nullptr;
+        Push(stack, rest);
+      }
+    }
+  }
+  if (auto block = list.head) {
+    list.head = block->next;
+    return block;
+  }
+  heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  return ::operator new((index + 1) * kGranularity);
+}
+
+void EventPool::Release(void* block, size_t size) {
+  if (!block) {
+    return;
+  }
+  auto index = size_class(size);
+  if (index == kSizeClasses) {
+    ::operator delete(block);
+    return;
+  }
+  auto& stack = return_stack(index);
+  // NOTE: The size is approximate while pushes and refills race, which only
+  // matters for how many blocks are kept.
+  if (stack.size.fetch_add(1, std::memory_order_relaxed) >= kMaxFreeBlocks) {
+    stack.size.fetch_sub(1, std::memory_order_relaxed);
+    ::operator delete(block);
+    return;
+  }
+  auto head = static_cast<Block*>(block);
+  head->next = nullptr;
+  Push(stack, head);
+}
+
+uint64_t EventPool::allocations() {
+  return heap_allocations.load(std::memory_order_relaxed);
+}
+
+}  // namespace node_webrtc
@@ -0,0 +1,52 @@
+/* Copyright (c) 2019 The node-webrtc project authors. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found
+ * in the LICENSE.md file in the root of the source tree. All contributing
+ * project authors may be found in the AUTHORS file in the root of the source
+ * tree.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace node_webrtc {
+
+/**
+ * EventPool recycles the memory of Events. Events are created on libwebrtc's
+ * threads and destroyed on the JavaScript thread at a high rate, so rather
+ * than return their memory to the heap, EventPool keeps it in per-size free
+ * lists. Once warmed up, creating and destroying an Event does not allocate.
+ * Blocks can be acquired and released from any thread. Each thread acquires
+ * from its own cache, which it refills from a lock-free stack of blocks
+ * released by other threads, so neither operation takes a lock.
+ */
+class EventPool {
+ public:
+  /**
+   * The most blocks of each size a thread takes into its cache at once.
+   */
+  static constexpr size_t kMaxCachedBlocks = 64;
+
+  /**
+   * Acquire a block of memory, reusing a released one if possible.
+   * @param size the size of the block
+   * @return the block
+   */
+  static void* Acquire(size_t size);
+
+  /**
+   * Release a block of memory acquired with Acquire.
+   * @param block the block
+   * @param size the size it was acquired with
+   */
+  static void Release(void* block, size_t size);
+
+  /**
+   * Get the number of blocks ever allocated from the heap.
+   * @return the number of blocks
+   */
+  static uint64_t allocations();
+};
+
+}  // namespace node_webrtc
@@ -7,52 +7,125 @@
  */
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
-#include <mutex>
-#include <queue>
 
-#include "events.h"
+#include "src/node/events.h"
+#include "src/node/mpsc_queue.h"
 
 namespace node_webrtc {
 
 /**
  * EventQueue is a thread-safe Event queue. It allows you to enqueue events
- * from one thread and dequeue them from another (or the same).
+ * from any number of threads and dequeue them from one. It is lock-free; see
+ * MpscQueue. Each EventPriority has its own lane: Events are dequeued in order
+ * within a lane, and control Events are dequeued before bulk Events.
  * @tparam T the Event target type
  */
 template <typename T>
 class EventQueue {
  public:
+  EventQueue() = default;
+
+  virtual ~EventQueue() {
+    while (Dequeue()) {
+      // Do nothing.
+    }
+  }
+
   /**
-   * Enqueue an Event.
+   * Enqueue an Event. This can be called from any thread.
    * @param event the event to enqueue
+   * @param priority the lane to enqueue the Event in
+   */
+  void Enqueue(std::unique_ptr<Event<T>> event, EventPriority priority = EventPriority::kControl) {
+    // NOTE: Count the Event before it becomes visible, so that size
+    // never drops below zero.
+    if (event->counted()) {
+      Hold();
+    }
+    _lanes[static_cast<size_t>(priority)].Push(event.release());
+  }
+
+  /**
+   * Count an Event that waits outside the EventQueue towards its size, for
+   * example one held back by a queue limit. This can be called from any thread.
+   */
+  void Hold() {
+    auto size = _size.fetch_add(1, std::memory_order_relaxed) + 1;
+    auto peak_size = _peak_size.load(std::memory_order_relaxed);
+    while (size > peak_size && !_peak_size.compare_exchange_weak(peak_size, size, std::memory_order_relaxed)) {
+      // Do nothing.
+    }
+  }
+
+  /**
+   * Stop counting an Event counted with Hold. This can be called from any
+   * thread.
    */
-  void Enqueue(std::unique_ptr<Event<T>> event) {
-    _mutex.lock();
-    _events.push(std::move(event));
-    _mutex.unlock();
+  void Unhold() {
+    _size.fetch_sub(1, std::memory_order_relaxed);
   }
 
   /**
-   * Attempt to dequeue an Event. If the EventQueue is empty, this method
-   * returns nullptr.
+   * Attempt to dequeue an Event, control Events first. If the EventQueue is
+   * empty, this method returns nullptr. Only one thread may call this at a
+   * time.
    * @return the dequeued Event or nullptr
    */
   std::unique_ptr<Event<T>> Dequeue() {
-    _mutex.lock();
-    if (_events.empty()) {
-      _mutex.unlock();
+    auto event = Dequeue(EventPriority::kControl);
+    return event ? std::move(event) : Dequeue(EventPriority::kBulk);
+  }
+
+  /**
+   * Attempt to dequeue an Event from one lane. If the lane is empty, this
+   * method returns nullptr. Only one thread may call this at a time.
+   * @param priority the lane to dequeue from
+   * @return the dequeued Event or nullptr
+   */
+  std::unique_ptr<Event<T>> Dequeue(EventPriority priority) {
+    auto event = _lanes[static_cast<size_t>(priority)].Pop();
+    if (!event) {
       return nullptr;
     }
-    auto event = std::move(_events.front());
-    _events.pop();
-    _mutex.unlock();
-    return event;
+    if (event->counted()) {
+      Unhold();
+    }
+    return std::unique_ptr<Event<T>>(event);
+  }
+
+  /**
+   * Whether a lane has no Event to dequeue. Only the thread that dequeues may
+   * call this.
+   * @param priority the lane to check
+   * @return whether the lane is empty
+   */
+  bool empty(EventPriority priority) const {
+    return _lanes[static_cast<size_t>(priority)].empty();
+  }
+
+  /**
+   * Get the number of counted Events currently enqueued or held.
+   * @return the number of Events
+   */
+  size_t size() const {
+    return _size.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Get the largest number of counted Events ever enqueued or held at once.
+   * @return the number of Events
+   */
+  size_t peak_size() const {
+    return _peak_size.load(std::memory_order_relaxed);
   }
 
  private:
-  std::queue<std::unique_ptr<Event<T>>> _events;
-  std::mutex _mutex{};
+  MpscQueue<Event<T>> _lanes[kEventPriorities];
+  std::atomic<size_t> _size = {0};
+  std::atomic<size_t> _peak_size = {0};
 };
 
 }  // namespace node_webrtc
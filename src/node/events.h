@@ -7,18 +7,47 @@
  */
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 
+#include "src/node/event_pool.h"
+#include "src/node/mpsc_queue.h"
+
 namespace node_webrtc {
 
 /**
- * Event represents an event that can be dispatched to a target.
+ * EventPriority selects the lane an Event waits in. Control Events (state
+ * changes, ICE candidates, Promise resolutions) are always dispatched before
+ * bulk Events (media frames, RTCDataChannel messages).
+ */
+enum class EventPriority {
+  kControl,
+  kBulk
+};
+
+static constexpr size_t kEventPriorities = 2;
+
+/**
+ * Event represents an event that can be dispatched to a target. Events are
+ * MpscNodes, so enqueueing one does not allocate, and their memory comes from
+ * an EventPool, so creating one usually does not allocate either.
  * @tparam T the target type
  */
 template<typename T>
-class Event {
+class Event: public MpscNode {
  public:
+  static void* operator new(size_t size) {
+    return EventPool::Acquire(size);
+  }
+
+  // NOTE: Event's destructor is virtual, so size is the size of the
+  // most-derived Event.
+  static void operator delete(void* block, size_t size) {
+    EventPool::Release(block, size);
+  }
+
   /**
    * Dispatch the Event to the target.
    * @param target the target to dispatch to
@@ -29,9 +58,38 @@ class Event {
 
   virtual ~Event() = default;
 
+  /**
+   * Get when the Event was dispatched to its EventLoop, per EventMetrics::Now.
+   * @return the time in microseconds
+   */
+  int64_t enqueued_at() const {
+    return _enqueued_at;
+  }
+
+  void set_enqueued_at(int64_t enqueued_at) {
+    _enqueued_at = enqueued_at;
+  }
+
+  /**
+   * Whether the Event counts towards its EventQueue's size and its EventLoop's
+   * metrics. Only an EventLoop's own bookkeeping Events do not.
+   * @return whether the Event is counted
+   */
+  bool counted() const {
+    return _counted;
+  }
+
+  void set_counted(bool counted) {
+    _counted = counted;
+  }
+
   static std::unique_ptr<Event<T>> Create() {
     return std::unique_ptr<Event<T>>(new Event<T>());
   }
+
+ private:
+  int64_t _enqueued_at = 0;
+  bool _counted = true;
 };
 
 template <typename F, typename T>
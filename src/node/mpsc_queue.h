@@ -0,0 +1,103 @@
+/* Copyright (c) 2019 The node-webrtc project authors. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found
+ * in the LICENSE.md file in the root of the source tree. All contributing
+ * project authors may be found in the AUTHORS file in the root of the source
+ * tree.
+ */
+#pragma once
+
+#include <atomic>
+
+namespace node_webrtc {
+
+/**
+ * An MpscNode can be linked into an MpscQueue. A node can be in at most one
+ * MpscQueue at a time.
+ */
+class MpscNode {
+  template <typename> friend class MpscQueue;
+
+  std::atomic<MpscNode*> _mpsc_next = {nullptr};
+};
+
+/**
+ * MpscQueue is an unbounded, intrusive, lock-free multi-producer
+ * single-consumer queue (after Dmitry Vyukov's). Push is a single atomic
+ * exchange and never allocates. While another thread is part way through
+ * Push, Pop may briefly return nullptr even though the MpscQueue is not empty;
+ * producers which wake the consumer after Push returns never strand a node.
+ * The MpscQueue does not own its nodes.
+ * @tparam N the node type, which must derive from MpscNode
+ */
+template <typename N>
+class MpscQueue {
+ public:
+  MpscQueue(): _head(&_stub), _tail(&_stub) {}
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  /**
+   * Push a node. This can be called from any thread.
+   * @param node the node to push
+   */
+  void Push(N* node) {
+    PushNode(node);
+  }
+
+  /**
+   * Attempt to pop a node. Only one thread may call this at a time.
+   * @return the popped node or nullptr
+   */
+  N* Pop() {
+    auto tail = _tail;
+    auto next = tail->_mpsc_next.load(std::memory_order_acquire);
+    if (tail == &_stub) {
+      if (!next) {
+        return nullptr;
+      }
+      _tail = next;
+      tail = next;
+      next = next->_mpsc_next.load(std::memory_order_acquire);
+    }
+    if (next) {
+      _tail = next;
+      return static_cast<N*>(tail);
+    }
+    if (tail != _head.load(std::memory_order_acquire)) {
+      // NOTE: A producer has claimed the head but not yet linked it.
+      return nullptr;
+    }
+    PushNode(&_stub);
+    next = tail->_mpsc_next.load(std::memory_order_acquire);
+    if (next) {
+      _tail = next;
+      return static_cast<N*>(tail);
+    }
+    return nullptr;
+  }
+
+  /**
+   * Whether there is no node to pop. Like Pop, this may briefly return true
+   * while another thread is part way through Push. Only the thread that pops
+   * may call this.
+   * @return whether the MpscQueue is empty
+   */
+  bool empty() const {
+    return _tail == &_stub && !_stub._mpsc_next.load(std::memory_order_acquire);
+  }
+
+ private:
+  void PushNode(MpscNode* node) {
+    node->_mpsc_next.store(nullptr, std::memory_order_relaxed);
+    auto previous = _head.exchange(node, std::memory_order_acq_rel);
+    previous->_mpsc_next.store(node, std::memory_order_release);
+  }
+
+  MpscNode _stub;
+  std::atomic<MpscNode*> _head;
+  MpscNode* _tail;
+};
+
+}  // namespace node_webrtc
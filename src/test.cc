@@ -9,11 +9,24 @@
 
 #include "src/test.h"
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
 #define CATCH_CONFIG_RUNNER
 #include <catch2/catch.hpp>
 
 #include "src/converters.h"
 #include "src/converters/napi.h"
+#include "src/node/event_dispatcher.h"
+#include "src/node/event_pool.h"
+#include "src/node/event_queue.h"
+#include "src/utilities/latency_histogram.h"
 
 TEST_CASE("converting booleans", "[converting-booleans]") {
   auto env = *node_webrtc::Test::env;
@@ -108,12 +121,353 @@ TEST_CASE("converting arrays", "[converting-arrays]") {
   }
 }
 
+TEST_CASE("recording latencies", "[recording-latencies]") {
+  SECTION("durations are bucketed by powers of two") {
+    REQUIRE(node_webrtc::LatencyHistogram::Bucket(0) == 0);
+    REQUIRE(node_webrtc::LatencyHistogram::Bucket(1) == 1);
+    REQUIRE(node_webrtc::LatencyHistogram::Bucket(3) == 2);
+    REQUIRE(node_webrtc::LatencyHistogram::Bucket(4) == 3);
+    REQUIRE(node_webrtc::LatencyHistogram::Bucket(INT64_MAX) == node_webrtc::LatencyHistogram::kBuckets - 1);
+  }
+
+  SECTION("every duration is below its bucket's upper bound") {
+    for (int64_t micros : { 0, 1, 2, 1000, 999999 }) {
+      REQUIRE(micros < node_webrtc::LatencyHistogram::UpperBound(node_webrtc::LatencyHistogram::Bucket(micros)));
+    }
+  }
+
+  SECTION("recording increments a bucket") {
+    node_webrtc::LatencyHistogram histogram;
+    histogram.Record(3);
+    histogram.Record(3);
+    REQUIRE(histogram.count(2) == 2);
+    REQUIRE(histogram.count(1) == 0);
+  }
+}
+
+TEST_CASE("budgeting events", "[budgeting-events]") {
+  SECTION("a turn ends after its limit, but the wake continues") {
+    node_webrtc::EventBudget budget(0, 2, std::chrono::microseconds(0));
+    budget.Spend();
+    REQUIRE(budget.available());
+    budget.Spend();
+    REQUIRE(!budget.available());
+    REQUIRE(!budget.exhausted());
+    budget.NextTurn();
+    REQUIRE(budget.available());
+  }
+
+  SECTION("a wake ends after its limit") {
+    node_webrtc::EventBudget budget(3, 0, std::chrono::microseconds(0));
+    for (auto i = 0; i < 3; i++) {
+      REQUIRE(budget.available());
+      budget.Spend();
+      budget.NextTurn();
+    }
+    REQUIRE(budget.exhausted());
+    REQUIRE(!budget.available());
+    REQUIRE(budget.events() == 3);
+  }
+
+  SECTION("a wake ends after its time, but only once an event is dispatched") {
+    node_webrtc::EventBudget budget(0, 0, std::chrono::microseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    REQUIRE(budget.available());
+    budget.Spend();
+    REQUIRE(budget.exhausted());
+  }
+}
+
+TEST_CASE("pooling events", "[pooling-events]") {
+  struct Target {
+    size_t dispatched = 0;
+  };
+
+  // NOTE: This captures roughly what a "message" or "frame" Event
+  // does: a pointer, a timestamp and a reference-counted buffer.
+  auto buffer = std::make_shared<std::vector<uint8_t>>(1024);
+  auto dispatch = [&buffer](node_webrtc::EventQueue<Target>& queue, Target& target, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      queue.Enqueue(node_webrtc::CreateCallback<Target>([&target, buffer]() {
+        target.dispatched += buffer->empty() ? 0 : 1;
+      }), node_webrtc::EventPriority::kBulk);
+      if (i % 64 == 63) {
+        while (auto event = queue.Dequeue()) {
+          event->Dispatch(target);
+        }
+      }
+    }
+    while (auto event = queue.Dequeue()) {
+      event->Dispatch(target);
+    }
+  };
+
+  SECTION("dispatching events does not allocate once the pool is warm") {
+    node_webrtc::EventQueue<Target> queue;
+    Target target;
+    dispatch(queue, target, 1000);
+    auto allocations = node_webrtc::EventPool::allocations();
+    dispatch(queue, target, 100000);
+    REQUIRE(node_webrtc::EventPool::allocations() == allocations);
+    REQUIRE(target.dispatched == 101000);
+  }
+
+  SECTION("dispatching events across threads does not allocate once the pool is warm") {
+    node_webrtc::EventQueue<Target> queue;
+    Target target;
+    auto produce = [&queue, &target, &buffer](size_t n) {
+      std::thread producer([&queue, &target, &buffer, n]() {
+        for (size_t i = 0; i < n; i++) {
+          queue.Enqueue(node_webrtc::CreateCallback<Target>([&target, buffer]() {
+            target.dispatched += buffer->empty() ? 0 : 1;
+          }), node_webrtc::EventPriority::kBulk);
+        }
+      });
+      producer.join();
+      while (auto event = queue.Dequeue()) {
+        event->Dispatch(target);
+      }
+    };
+    // NOTE: Each producer is a new thread, with an empty cache, so this is
+    // the worst case: every block comes back through the return stack.
+    produce(64);
+    auto allocations = node_webrtc::EventPool::allocations();
+    for (size_t i = 0; i < 100; i++) {
+      produce(64);
+    }
+    REQUIRE(node_webrtc::EventPool::allocations() == allocations);
+    REQUIRE(target.dispatched == 101 * 64);
+  }
+
+  SECTION("a thread's cache takes only some of the released blocks") {
+    // NOTE: No other test uses blocks this size.
+    constexpr size_t size = 496;
+    constexpr size_t n = 1024;
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < n; i++) {
+      blocks.push_back(node_webrtc::EventPool::Acquire(size));
+    }
+    for (auto block : blocks) {
+      node_webrtc::EventPool::Release(block, size);
+    }
+    blocks.clear();
+    std::thread other([]() {
+      node_webrtc::EventPool::Release(node_webrtc::EventPool::Acquire(size), size);
+    });
+    other.join();
+    auto allocations = node_webrtc::EventPool::allocations();
+    for (size_t i = 0; i < n - node_webrtc::EventPool::kMaxCachedBlocks + 1; i++) {
+      blocks.push_back(node_webrtc::EventPool::Acquire(size));
+    }
+    REQUIRE(node_webrtc::EventPool::allocations() == allocations);
+    for (auto block : blocks) {
+      node_webrtc::EventPool::Release(block, size);
+    }
+  }
+
+  SECTION("events can be created and destroyed on different threads") {
+    node_webrtc::EventQueue<Target> queue;
+    Target target;
+    const size_t events = 100000;
+    std::thread producer([&queue, &target]() {
+      for (size_t i = 0; i < events; i++) {
+        queue.Enqueue(node_webrtc::CreateCallback<Target>([&target]() {
+          target.dispatched++;
+        }));
+      }
+    });
+    while (target.dispatched < events) {
+      if (auto event = queue.Dequeue()) {
+        event->Dispatch(target);
+      }
+    }
+    producer.join();
+    REQUIRE(queue.Dequeue() == nullptr);
+  }
+}
+
+TEST_CASE("enqueueing and dequeueing events", "[enqueueing-and-dequeueing-events]") {
+  struct Target {
+    std::vector<int> dispatched;
+  };
+
+  class Numbered: public node_webrtc::Event<Target> {
+   public:
+    explicit Numbered(int number): _number(number) {}
+    void Dispatch(Target& target) override {
+      target.dispatched.push_back(_number);
+    }
+   private:
+    int _number;
+  };
+
+  SECTION("events are dequeued in order") {
+    node_webrtc::EventQueue<Target> queue;
+    Target target;
+    REQUIRE(queue.Dequeue() == nullptr);
+    for (int i = 0; i < 3; i++) {
+      queue.Enqueue(std::unique_ptr<node_webrtc::Event<Target>>(new Numbered(i)));
+    }
+    REQUIRE(queue.size() == 3);
+    while (auto event = queue.Dequeue()) {
+      event->Dispatch(target);
+    }
+    REQUIRE(target.dispatched == std::vector<int>({ 0, 1, 2 }));
+    REQUIRE(queue.size() == 0);
+    REQUIRE(queue.peak_size() == 3);
+  }
+
+  SECTION("control events are dequeued before bulk events") {
+    node_webrtc::EventQueue<Target> queue;
+    Target target;
+    queue.Enqueue(std::unique_ptr<node_webrtc::Event<Target>>(new Numbered(0)), node_webrtc::EventPriority::kBulk);
+    queue.Enqueue(std::unique_ptr<node_webrtc::Event<Target>>(new Numbered(1)), node_webrtc::EventPriority::kBulk);
+    queue.Enqueue(std::unique_ptr<node_webrtc::Event<Target>>(new Numbered(2)), node_webrtc::EventPriority::kControl);
+    REQUIRE(queue.Dequeue(node_webrtc::EventPriority::kBulk) != nullptr);
+    REQUIRE(queue.size() == 2);
+    while (auto event = queue.Dequeue()) {
+      event->Dispatch(target);
+    }
+    REQUIRE(target.dispatched == std::vector<int>({ 2, 1 }));
+  }
+
+  SECTION("a lane is empty once its last event is dequeued") {
+    node_webrtc::EventQueue<Target> queue;
+    REQUIRE(queue.empty(node_webrtc::EventPriority::kControl));
+    REQUIRE(queue.empty(node_webrtc::EventPriority::kBulk));
+    queue.Enqueue(std::unique_ptr<node_webrtc::Event<Target>>(new Numbered(0)), node_webrtc::EventPriority::kBulk);
+    queue.Enqueue(std::unique_ptr<node_webrtc::Event<Target>>(new Numbered(1)), node_webrtc::EventPriority::kBulk);
+    REQUIRE(queue.empty(node_webrtc::EventPriority::kControl));
+    REQUIRE(!queue.empty(node_webrtc::EventPriority::kBulk));
+    REQUIRE(queue.Dequeue() != nullptr);
+    REQUIRE(!queue.empty(node_webrtc::EventPriority::kBulk));
+    REQUIRE(queue.Dequeue() != nullptr);
+    REQUIRE(queue.empty(node_webrtc::EventPriority::kBulk));
+  }
+
+  SECTION("every event from every producer is dequeued") {
+    const int producers = 4;
+    const int events = 10000;
+    node_webrtc::EventQueue<Target> queue;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < producers; i++) {
+      threads.emplace_back([&queue, i]() {
+        for (int j = 0; j < events; j++) {
+          queue.Enqueue(std::unique_ptr<node_webrtc::Event<Target>>(new Numbered(i * events + j)));
+        }
+      });
+    }
+    Target target;
+    while (target.dispatched.size() < static_cast<size_t>(producers * events)) {
+      if (auto event = queue.Dequeue()) {
+        event->Dispatch(target);
+      }
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    std::vector<int> last(producers, -1);
+    for (auto number : target.dispatched) {
+      auto producer = number / events;
+      REQUIRE(number > last[producer]);
+      last[producer] = number;
+    }
+    REQUIRE(queue.Dequeue() == nullptr);
+  }
+}
+
+namespace {
+
+/**
+ * The mutex-guarded queue EventQueue used to be, kept for comparison.
+ */
+template <typename T>
+class LockingEventQueue {
+ public:
+  void Enqueue(std::unique_ptr<node_webrtc::Event<T>> event) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _events.push(std::move(event));
+  }
+
+  std::unique_ptr<node_webrtc::Event<T>> Dequeue() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_events.empty()) {
+      return nullptr;
+    }
+    auto event = std::move(_events.front());
+    _events.pop();
+    return event;
+  }
+
+ private:
+  std::queue<std::unique_ptr<node_webrtc::Event<T>>> _events;
+  std::mutex _mutex;
+};
+
+struct BenchmarkTarget {};
+
+/**
+ * Measure the nanoseconds per event for `producers` threads to enqueue
+ * `events` events each while one thread dequeues them.
+ */
+template <typename Q>
+double MeasureQueue(size_t producers, size_t events) {
+  Q queue;
+  std::atomic<bool> started = {false};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < producers; i++) {
+    threads.emplace_back([&queue, &started, events]() {
+      while (!started) {
+        std::this_thread::yield();
+      }
+      for (size_t j = 0; j < events; j++) {
+        queue.Enqueue(node_webrtc::Event<BenchmarkTarget>::Create());
+      }
+    });
+  }
+  auto start = std::chrono::steady_clock::now();
+  started = true;
+  size_t dequeued = 0;
+  while (dequeued < producers * events) {
+    if (queue.Dequeue()) {
+      dequeued++;
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return std::chrono::duration<double, std::nano>(elapsed).count() / dequeued;
+}
+
+}  // namespace
+
+// NOTE: This is hidden; run it with `node test/cpp.js [benchmark]`.
+TEST_CASE("benchmarking EventQueue", "[.][benchmark]") {
+  const size_t events = 200000;
+  for (size_t producers : { 1, 2, 4, 8, 16 }) {
+    auto locking = MeasureQueue<LockingEventQueue<BenchmarkTarget>>(producers, events);
+    auto lockFree = MeasureQueue<node_webrtc::EventQueue<BenchmarkTarget>>(producers, events);
+    WARN(producers << " producer(s): std::mutex " << locking << " ns/event, lock-free " << lockFree << " ns/event");
+  }
+}
+
 Napi::Env* node_webrtc::Test::env = nullptr;
 
 Napi::Value node_webrtc::Test::TestImpl(const Napi::CallbackInfo& info) {
   auto env = info.Env();
   Test::env = &env;
-  auto result = Catch::Session().run();
+  std::vector<std::string> args = { "node-webrtc" };
+  auto maybeArgs = node_webrtc::From<std::vector<std::string>>(info[0]);
+  if (maybeArgs.IsValid()) {
+    auto extra = maybeArgs.UnsafeFromValid();
+    args.insert(args.end(), extra.begin(), extra.end());
+  }
+  std::vector<const char*> argv;
+  for (auto const& arg : args) {
+    argv.push_back(arg.c_str());
+  }
+  auto result = Catch::Session().run(static_cast<int>(argv.size()), argv.data());
   CONVERT_OR_THROW_AND_RETURN_NAPI(info.Env(), result, value, Napi::Value)
   return value;
 }
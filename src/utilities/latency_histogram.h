@@ -0,0 +1,73 @@
+/* Copyright (c) 2019 The node-webrtc project authors. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style license that can be found
+ * in the LICENSE.md file in the root of the source tree. All contributing
+ * project authors may be found in the AUTHORS file in the root of the source
+ * tree.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace node_webrtc {
+
+/**
+ * A LatencyHistogram counts durations in power-of-two microsecond buckets.
+ * Bucket 0 counts durations under 1 µs, bucket i counts durations under 2^i µs
+ * (but not under 2^(i-1) µs), and the last bucket counts everything longer.
+ * Recording is a single relaxed atomic increment, so it is cheap enough to
+ * leave on.
+ */
+class LatencyHistogram {
+ public:
+  static const size_t kBuckets = 24;
+
+  /**
+   * Record a duration.
+   * @param micros the duration in microseconds
+   */
+  void Record(int64_t micros) {
+    _counts[Bucket(micros)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Get the number of durations recorded in a bucket.
+   * @param bucket the bucket
+   * @return the number of durations
+   */
+  uint64_t count(size_t bucket) const {
+    return _counts[bucket].load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Get the bucket a duration is recorded in.
+   * @param micros the duration in microseconds
+   * @return the bucket
+   */
+  static size_t Bucket(int64_t micros) {
+    size_t bucket = 0;
+    while (micros > 0 && bucket < kBuckets - 1) {
+      micros >>= 1;
+      bucket++;
+    }
+    return bucket;
+  }
+
+  /**
+   * Get the exclusive upper bound of a bucket in microseconds. The last bucket
+   * is unbounded.
+   * @param bucket the bucket
+   * @return the upper bound
+   */
+  static int64_t UpperBound(size_t bucket) {
+    return int64_t(1) << bucket;
+  }
+
+ private:
+  std::array<std::atomic<uint64_t>, kBuckets> _counts{};
+};
+
+}  // namespace node_webrtc
@@ -8,6 +8,7 @@ require('./closing-peer-connection');
 require('./connect');
 require('./create-offer');
 require('./custom-settings');
+require('./eventloop');
 require('./get-configuration');
 require('./i420helpers');
 require('./iceservers');
@@ -19,12 +20,15 @@ require('./rtcaudiosink');
 require('./rtcaudiosource');
 require('./rtcdtlstransport');
 require('./rtcdatachannel');
+require('./rtcdatachannelstream');
+require('./rtcdatachannelbridge');
 require('./rtcrtpreceiver');
 require('./rtcrtpsender');
 require('./rtcvideosink');
 require('./rtcvideosource');
 require('./send-arraybuffer');
 require('./sessiondesc');
+require('./state-change-events');
 
 // TODO(mroberts): async_hooks were introduced in Node 9. We use them to test
 // that destructors fire at the appropriate time (and hence, no memory leaks
@@ -4,6 +4,6 @@
 const binding = require('../lib/binding');
 
 if (typeof binding.test === 'function') {
-  const result = binding.test();
+  const result = binding.test(process.argv.slice(2));
   process.exit(result);
 }
@@ -0,0 +1,110 @@
+'use strict';
+
+const tape = require('tape');
+const { getEventLoopStats, nativeMetrics, setEventLoopBudget } = require('..').nonstandard;
+const { createConnectedDataChannels } = require('./lib/pc');
+
+tape('setEventLoopBudget(budget) rejects invalid budgets', t => {
+  t.throws(() => setEventLoopBudget(), TypeError);
+  t.throws(() => setEventLoopBudget({ maxTime: -1 }), TypeError);
+  t.throws(() => setEventLoopBudget({ maxEvents: 'foo' }), TypeError);
+  t.throws(() => setEventLoopBudget({ batchCallbacks: 'foo' }), TypeError);
+  t.end();
+});
+
+tape('Events over budget are delivered, in order, on a later wake', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  const n = 20;
+  const receivedPromise = new Promise(resolve => {
+    const received = [];
+    dc2.onmessage = ({ data }) => {
+      received.push(Number(data));
+      if (received.length === n) {
+        resolve(received);
+      }
+    };
+  });
+
+  const before = getEventLoopStats();
+  setEventLoopBudget({ maxEvents: 1, maxEventsPerObject: 1 });
+  for (let i = 0; i < n; i++) {
+    dc1.send(String(i));
+  }
+  const received = await receivedPromise;
+  setEventLoopBudget({ maxEvents: 0, maxEventsPerObject: 64 });
+
+  t.deepEqual(received, [...Array(n).keys()], 'every message is received in order');
+  const after = getEventLoopStats();
+  t.ok(after.wakeups > before.wakeups);
+  t.ok(after.eventsDispatched >= before.eventsDispatched + n);
+  t.equal(typeof after.eventAllocations, 'number');
+
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('With batchCallbacks, every event is still delivered, in order', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  const n = 100;
+  const receivedPromise = new Promise(resolve => {
+    const received = [];
+    dc2.onmessage = ({ data }) => {
+      received.push(Number(data));
+      if (received.length === n) {
+        resolve(received);
+      }
+    };
+  });
+
+  setEventLoopBudget({ batchCallbacks: true });
+  for (let i = 0; i < n; i++) {
+    dc1.send(String(i));
+  }
+  const received = await receivedPromise;
+  setEventLoopBudget({ batchCallbacks: false });
+
+  t.deepEqual(received, [...Array(n).keys()], 'every message is received in order');
+
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('nativeMetrics() reports events per class', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  const before = nativeMetrics().classes.RTCDataChannel;
+  const n = 10;
+  const receivedPromise = new Promise(resolve => {
+    let received = 0;
+    dc2.onmessage = () => {
+      if (++received === n) {
+        resolve();
+      }
+    };
+  });
+  for (let i = 0; i < n; i++) {
+    dc1.send(String(i));
+  }
+  await receivedPromise;
+
+  const metrics = nativeMetrics();
+  const after = metrics.classes.RTCDataChannel;
+  t.ok(after.eventsEnqueued >= before.eventsEnqueued + n);
+  t.ok(after.eventsDispatched >= before.eventsDispatched + n);
+  t.ok(after.peakQueueDepth >= after.queueDepth);
+  t.equal(typeof after.eventsDropped, 'number');
+  t.equal(after.dispatchLatency.reduce((count, bucket) => count + bucket.count, 0), after.eventsDispatched,
+    'every dispatched event is in the latency histogram');
+  t.ok(metrics.maxEventsPerWakeup >= 1);
+  t.ok(metrics.classes.RTCPeerConnection, 'RTCPeerConnection is reported too');
+
+  const { traceEvents } = nativeMetrics({ format: 'traceEvents' });
+  t.ok(traceEvents.every(event => event.ph === 'C' && typeof event.ts === 'number'));
+  t.ok(traceEvents.some(event => event.name === 'wrtc.RTCDataChannel'));
+  t.throws(() => nativeMetrics({ format: 'foo' }), TypeError);
+
+  pc1.close();
+  pc2.close();
+  t.end();
+});
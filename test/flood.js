@@ -0,0 +1,59 @@
+'use strict';
+
+// NOTE: This is a benchmark, like test/latency.js, not a test. It is not part
+// of test/all.js; run it with `node test/flood.js` and compare the two rates.
+
+const { performance } = require('perf_hooks');
+const tape = require('tape');
+
+const { setEventLoopBudget } = require('..').nonstandard;
+
+const { createConnectedDataChannels } = require('./lib/pc');
+
+async function measureFlood(batchCallbacks, n) {
+  n = typeof n === 'number' ? n : 100000;
+
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  try {
+    setEventLoopBudget({ batchCallbacks });
+
+    let received = 0;
+    let start;
+    const receivedPromise = new Promise(resolve => {
+      dc2.onmessage = () => {
+        if (!received++) {
+          start = performance.now();
+        }
+        if (received === n) {
+          resolve(performance.now() - start);
+        }
+      };
+    });
+
+    const message = new Uint8Array(64);
+    for (let i = 0; i < n; i++) {
+      dc1.send(message);
+    }
+
+    const time = await receivedPromise;
+    return n / time * 1000;
+  } finally {
+    setEventLoopBudget({ batchCallbacks: false });
+    pc1.close();
+    pc2.close();
+  }
+}
+
+function testFlood(t, batchCallbacks) {
+  t.test(`Messages per Second Flooding an RTCDataChannel (batchCallbacks: ${batchCallbacks})`, async t => {
+    const rate = await measureFlood(batchCallbacks);
+    console.log(`#
+#  ${Math.round(rate)} messages/s
+#
+`);
+    t.end();
+  });
+}
+
+testFlood(tape, false);
+testFlood(tape, true);
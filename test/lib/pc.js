@@ -93,6 +93,20 @@ async function confirmSentFrameDimensions(source, track, pc, frame) {
   });
 }
 
+async function createConnectedDataChannels(options = {}) {
+  let dc1;
+  const [pc1, pc2] = await negotiateRTCPeerConnections({
+    withPc1(pc1) {
+      dc1 = pc1.createDataChannel('test', options);
+    }
+  });
+  const dc2 = await new Promise(resolve => {
+    pc2.ondatachannel = ({ channel }) => resolve(channel);
+  });
+  await waitForStateChange(dc1, 'open', { event: 'open', property: 'readyState' });
+  return { pc1, pc2, dc1, dc2 };
+}
+
 function waitForStateChange(target, state, options = {}) {
   options = {
     event: 'statechange',
@@ -130,6 +144,7 @@ function gatherCandidates(pc) {
 
 module.exports = {
   confirmSentFrameDimensions,
+  createConnectedDataChannels,
   createRTCPeerConnections,
   gatherCandidates,
   getLocalTrackStats,
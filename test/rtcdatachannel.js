@@ -2,6 +2,7 @@
 
 const tape = require('tape');
 const { RTCPeerConnection } = require('..');
+const { createConnectedDataChannels } = require('./lib/pc');
 
 tape('Calling .send(message) when .readyState is "closed" throws InvalidStateError', t => {
   const pc = new RTCPeerConnection();
@@ -30,3 +31,387 @@ tape('.negotiated', t => {
   pc.close();
   t.end();
 });
+
+tape('.readyState, .id and .bufferedAmount track the underlying RTCDataChannel', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  t.equal(dc1.readyState, 'open');
+  t.equal(dc1.id, dc2.id, 'both ends see the assigned id');
+  t.equal(dc1.label, dc2.label);
+  dc1.send('hello');
+  await new Promise(resolve => dc2.addEventListener('message', resolve));
+  t.equal(dc1.bufferedAmount, 0);
+  dc1.close();
+  t.equal(dc1.readyState, 'closing');
+  await new Promise(resolve => dc1.addEventListener('close', resolve));
+  t.equal(dc1.readyState, 'closed');
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('.send(string) delivers ASCII, non-ASCII and empty strings intact', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  const data = ['{"hello":"world"}', 'h\u00e9llo \u{1f30d}', '', 'a'.repeat(1000) + '\u00ff'];
+  const received = [];
+  const receivedPromise = new Promise(resolve => {
+    dc2.onmessage = ({ data: message }) => {
+      received.push(message);
+      if (received.length === data.length) {
+        resolve();
+      }
+    };
+  });
+  data.forEach(message => dc1.send(message));
+  await receivedPromise;
+  t.deepEqual(received, data);
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('.getNativeStats() counts messages, bytes and dispatch latency', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  const receivedPromise = new Promise(resolve => {
+    let received = 0;
+    dc2.onmessage = () => {
+      if (++received === 2) {
+        resolve();
+      }
+    };
+  });
+  dc1.send('hello');
+  dc1.send(new Uint8Array(10));
+  await receivedPromise;
+
+  const sent = dc1.getNativeStats();
+  t.equal(sent.messagesSent, 2);
+  t.equal(sent.bytesSent, 15);
+
+  const received = dc2.getNativeStats();
+  t.equal(received.messagesReceived, 2);
+  t.equal(received.bytesReceived, 15);
+  t.equal(received.queueDepth, 0, 'every event has been dispatched');
+  t.ok(received.peakQueueDepth >= 1);
+  const latencies = received.dispatchLatency.reduce((sum, { count }) => sum + count, 0);
+  t.equal(latencies, 2, 'every dispatched message is in the latency histogram');
+  t.equal(received.dispatchLatency[received.dispatchLatency.length - 1].lessThan, Infinity);
+
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('.createSendBuffer(byteLength) returns an ArrayBuffer that can be sent and released', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  t.throws(() => dc1.createSendBuffer(0), RangeError, 'empty SendBuffers are rejected');
+  const buffer = dc1.createSendBuffer(1024);
+  t.equal(buffer.byteLength, 1024);
+  new Uint8Array(buffer).fill(7);
+
+  const messagePromise = new Promise(resolve => { dc2.onmessage = ({ data }) => resolve(data); });
+  const releasePromise = new Promise(resolve => { dc1.onsendbufferrelease = ({ buffer }) => resolve(buffer); });
+  dc1.send(buffer);
+
+  const [message, released] = await Promise.all([messagePromise, releasePromise]);
+  t.equal(released, buffer, 'the SendBuffer is released');
+  t.ok(new Uint8Array(message).every(x => x === 7), 'every byte is received');
+
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('SendBuffers are shared when sent as a full view or with .sendMany()', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  const first = dc1.createSendBuffer(16);
+  const second = dc1.createSendBuffer(16);
+  const copied = new ArrayBuffer(16);
+
+  const released = [];
+  const releasePromise = new Promise(resolve => {
+    dc1.onsendbufferrelease = ({ buffer }) => {
+      released.push(buffer);
+      if (released.length === 2) {
+        resolve();
+      }
+    };
+  });
+  let received = 0;
+  const messagePromise = new Promise(resolve => {
+    dc2.onmessage = () => {
+      if (++received === 3) {
+        resolve();
+      }
+    };
+  });
+  dc1.send(new Uint8Array(first));
+  t.equal(dc1.sendMany([second, copied]), 2);
+
+  await Promise.all([releasePromise, messagePromise]);
+  t.deepEqual(released, [first, second], 'only the SendBuffers are released, in order');
+
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('.sendMany(data) sends every message in order and returns the number accepted', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  const data = ['a', new Uint8Array([1, 2, 3]), 'c'];
+  const received = [];
+  const receivedPromise = new Promise(resolve => {
+    dc2.onmessage = ({ data: message }) => {
+      received.push(message);
+      if (received.length === data.length) {
+        resolve();
+      }
+    };
+  });
+  t.equal(dc1.sendMany(data), data.length, 'every message is accepted');
+  await receivedPromise;
+  t.equal(received[0], 'a');
+  t.deepEqual([...new Uint8Array(received[1])], [1, 2, 3]);
+  t.equal(received[2], 'c');
+  t.throws(() => dc1.sendMany(['a', 1]), /TypeError/, 'invalid messages throw');
+
+  pc1.close();
+  pc2.close();
+  t.throws(() => dc1.sendMany(['a']), /RTCDataChannel.readyState is not 'open'/);
+  t.end();
+});
+
+tape('.sendMany(data) stops counting the messages libwebrtc refuses toward .bufferedAmount', async t => {
+  const { pc1, pc2, dc1 } = await createConnectedDataChannels();
+  // NOTE: libwebrtc closes the RTCDataChannel when a message exceeds the
+  // maximum message size, and refuses every message after it.
+  const tooLarge = new Uint8Array(1024 * 1024);
+  const refused = new Uint8Array(2 * 1024 * 1024);
+  dc1.bufferedAmountLowThreshold = refused.byteLength;
+  const accepted = dc1.sendMany(['a', tooLarge, refused]);
+  t.ok(accepted < 3, 'some messages are refused');
+  t.ok(dc1.bufferedAmount <= 1 + tooLarge.byteLength,
+    '.bufferedAmount does not count the refused messages');
+  t.ok(dc1.bufferedAmount <= dc1.bufferedAmountLowThreshold,
+    '.bufferedAmount fell back to .bufferedAmountLowThreshold');
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('.bufferedAmountLowThreshold and .bufferedAmountHighThreshold', t => {
+  const pc = new RTCPeerConnection();
+  const dc = pc.createDataChannel('test');
+  t.equal(dc.bufferedAmountLowThreshold, 0, '.bufferedAmountLowThreshold is initially 0');
+  t.equal(dc.bufferedAmountHighThreshold, 0, '.bufferedAmountHighThreshold is initially 0');
+  dc.bufferedAmountLowThreshold = 1024;
+  dc.bufferedAmountHighThreshold = 4096;
+  t.equal(dc.bufferedAmountLowThreshold, 1024);
+  t.equal(dc.bufferedAmountHighThreshold, 4096);
+  pc.close();
+  t.end();
+});
+
+tape('"bufferedamountlow" is raised once the buffered amount falls to .bufferedAmountLowThreshold', async t => {
+  const { pc1, pc2, dc1 } = await createConnectedDataChannels();
+  dc1.bufferedAmountLowThreshold = 1024;
+  const lowPromise = new Promise(resolve => { dc1.onbufferedamountlow = resolve; });
+  for (let i = 0; i < 64; i++) {
+    dc1.send(new Uint8Array(16384));
+  }
+  await lowPromise;
+  t.ok(dc1.bufferedAmount <= 1024, '.bufferedAmount is at most .bufferedAmountLowThreshold');
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('.batchMessages delivers messages in order with "messages" events', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  t.equal(dc2.batchMessages, false, '.batchMessages is initially false');
+  dc2.batchMessages = true;
+
+  const n = 100;
+  const received = [];
+  const receivedPromise = new Promise(resolve => {
+    dc2.onmessage = () => t.fail('unexpected "message" event');
+    dc2.onmessages = ({ data }) => {
+      received.push(...data);
+      if (received.length === n) {
+        resolve();
+      }
+    };
+  });
+  for (let i = 0; i < n; i++) {
+    dc1.send(String(i));
+  }
+  await receivedPromise;
+  t.deepEqual(received, [...Array(n).keys()].map(String), 'messages are received in order');
+
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('Reassigning .dispatchEvent takes effect for native events', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  const inherited = dc2.dispatchEvent;
+  t.equal(typeof inherited, 'function', '.dispatchEvent is inherited from EventTarget');
+
+  dc1.send('first');
+  await new Promise(resolve => dc2.addEventListener('message', resolve));
+
+  const receivedPromise = new Promise(resolve => {
+    dc2.dispatchEvent = event => {
+      dc2.dispatchEvent = inherited;
+      resolve(event);
+    };
+  });
+  dc1.send('second');
+  const event = await receivedPromise;
+  t.equal(event.type, 'message');
+  t.equal(event.data, 'second');
+  t.equal(dc2.dispatchEvent, inherited, 'restoring .dispatchEvent restores the original');
+
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('.dispatchEvent reads back after the RTCDataChannel closes, even after garbage collection', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  const closePromise = new Promise(resolve => {
+    // NOTE: This replaces EventTarget's dispatchEvent, so "close" arrives here.
+    dc2.dispatchEvent = function before(event) {
+      if (event.type === 'close') {
+        resolve(before);
+      }
+    };
+  });
+  dc1.close();
+  const before = await closePromise;
+  // NOTE: Let the RTCDataChannel stop, which releases its callbacks.
+  await new Promise(resolve => setTimeout(resolve, 10));
+  t.equal(dc2.dispatchEvent, before, 'a handler assigned before closing reads back');
+
+  dc2.dispatchEvent = () => {};
+  const after = dc2.dispatchEvent;
+  if (typeof global.gc === 'function') {
+    global.gc();
+  }
+  t.equal(dc2.dispatchEvent, after, 'a handler assigned after closing reads back');
+
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('Holding too many messages while paused raises "error" and closes the RTCDataChannel', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  const received = [];
+  dc2.onmessage = ({ data }) => received.push(data);
+  const errorPromise = new Promise(resolve => { dc2.onerror = ({ error }) => resolve(error); });
+  const closePromise = new Promise(resolve => { dc2.onclose = resolve; });
+  dc2._pause();
+
+  // NOTE: 64 messages of 256 KiB fill the 16 MiB held while paused.
+  const size = 256 * 1024;
+  const n = 72;
+  const message = new Uint8Array(size);
+  for (let i = 0; i < n && dc1.readyState === 'open'; i++) {
+    while (dc1.bufferedAmount > 1024 * 1024) {
+      await new Promise(resolve => setTimeout(resolve, 5));
+    }
+    if (dc1.readyState === 'open') {
+      dc1.send(message);
+    }
+  }
+
+  const error = await errorPromise;
+  t.ok(error instanceof Error, 'the RTCDataChannel raises "error"');
+  await closePromise;
+  t.equal(received.length, 64, 'messages held before the error are delivered before "close"');
+  t.ok(dc2.droppedEvents >= 1, 'the message past the limit is counted');
+
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('.setQueueLimit(limit) rejects invalid limits', t => {
+  const pc = new RTCPeerConnection();
+  const dc = pc.createDataChannel('dc');
+  t.throws(() => dc.setQueueLimit({ capacity: 1, policy: 'foo' }), TypeError);
+  t.throws(() => dc.setQueueLimit({ capacity: -1 }), TypeError);
+  t.throws(() => dc.setQueueLimit({ capacity: 1, policy: 'block' }), TypeError,
+    'the network thread is never blocked');
+  t.equal(dc.droppedEvents, 0);
+  pc.close();
+  t.end();
+});
+
+[
+  { policy: 'drop-oldest', capacity: 3, expected: ['7', '8', '9'] },
+  { policy: 'drop-newest', capacity: 3, expected: ['0', '1', '2'] },
+  { policy: 'coalesce', capacity: 3, expected: ['9'] }
+].forEach(({ policy, capacity, expected }) => {
+  tape(`.setQueueLimit({ policy: '${policy}' }) drops exactly the messages that do not fit`, async t => {
+    const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+    dc2.setQueueLimit({ capacity, policy });
+    const received = [];
+    dc2.onmessage = ({ data }) => received.push(data);
+
+    // NOTE: Hold the messages natively until every one has arrived. Resuming
+    // then queues them all at once, on the JavaScript thread, so none can be
+    // delivered in between.
+    dc2._pause();
+    const n = 10;
+    for (let i = 0; i < n; i++) {
+      dc1.send(String(i));
+    }
+    while (dc2.getNativeStats().messagesReceived < n) {
+      await new Promise(resolve => setTimeout(resolve, 10));
+    }
+    dc2._resume();
+    t.equal(dc2.getNativeStats().queueDepth, expected.length, 'waiting messages count towards queueDepth');
+    t.equal(dc2.droppedEvents, n - expected.length, 'the messages that do not fit are dropped');
+
+    while (received.length < expected.length) {
+      await new Promise(resolve => setTimeout(resolve, 10));
+    }
+    t.deepEqual(received, expected);
+    t.equal(dc2.getNativeStats().queueDepth, 0);
+
+    pc1.close();
+    pc2.close();
+    t.end();
+  });
+
+  tape(`.setQueueLimit({ policy: '${policy}' }) bounds the messages waiting in a batch`, async t => {
+    const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+    dc2.batchMessages = true;
+    dc2.setQueueLimit({ capacity, policy });
+    const batches = [];
+    dc2.onmessages = ({ data }) => batches.push(data);
+
+    dc2._pause();
+    const n = 10;
+    for (let i = 0; i < n; i++) {
+      dc1.send(String(i));
+    }
+    while (dc2.getNativeStats().messagesReceived < n) {
+      await new Promise(resolve => setTimeout(resolve, 10));
+    }
+    dc2._resume();
+    t.equal(dc2.getNativeStats().queueDepth, 1, 'the batch is a single event');
+    t.equal(dc2.droppedEvents, n - expected.length, 'the messages that do not fit are dropped');
+
+    while (!batches.length) {
+      await new Promise(resolve => setTimeout(resolve, 10));
+    }
+    t.deepEqual(batches, [expected]);
+
+    pc1.close();
+    pc2.close();
+    t.end();
+  });
+});
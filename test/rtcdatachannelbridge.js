@@ -0,0 +1,98 @@
+'use strict';
+
+const net = require('net');
+const tape = require('tape');
+
+const { RTCPeerConnection } = require('..');
+const { createConnectedDataChannels } = require('./lib/pc');
+
+function listen(server) {
+  return new Promise(resolve => server.listen(0, '127.0.0.1', resolve));
+}
+
+tape('RTCDataChannel.bridgeTo({ host, port }) relays bytes in both directions', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  dc1.binaryType = 'arraybuffer';
+
+  const socketPromise = new Promise(resolve => {
+    const server = net.createServer(socket => {
+      server.close();
+      resolve(socket);
+    });
+    listen(server).then(() => {
+      dc2.bridgeTo({ host: '127.0.0.1', port: server.address().port });
+    });
+  });
+
+  await new Promise(resolve => dc2.addEventListener('bridgeopen', resolve));
+  const socket = await socketPromise;
+
+  const fromChannel = new Promise(resolve => socket.once('data', resolve));
+  dc1.send(new Uint8Array([1, 2, 3]));
+  t.deepEqual([...await fromChannel], [1, 2, 3], 'bytes sent on the RTCDataChannel are written to the socket');
+
+  const fromSocket = new Promise(resolve => dc1.addEventListener('message', resolve));
+  socket.write(Buffer.from([4, 5, 6]));
+  t.deepEqual([...new Uint8Array((await fromSocket).data)], [4, 5, 6], 'bytes written to the socket are sent on the RTCDataChannel');
+
+  t.throws(() => dc2.bridgeTo({ host: '127.0.0.1', port: 1 }), /already bridged/);
+
+  const bridgeClose = new Promise(resolve => dc2.addEventListener('bridgeclose', resolve));
+  const close = new Promise(resolve => dc1.addEventListener('close', resolve));
+  socket.end();
+  await bridgeClose;
+  await close;
+  t.pass('closing the socket closes the RTCDataChannel');
+
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('RTCDataChannel.bridgeTo(target) closes with an error once too much is queued for the socket', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+
+  const socketPromise = new Promise(resolve => {
+    const server = net.createServer(socket => {
+      server.close();
+      socket.pause();
+      resolve(socket);
+    });
+    listen(server).then(() => {
+      dc2.bridgeTo({ host: '127.0.0.1', port: server.address().port });
+    });
+  });
+  await new Promise(resolve => dc2.addEventListener('bridgeopen', resolve));
+  const socket = await socketPromise;
+
+  // NOTE: The socket never reads, so once the kernel's buffers fill up, the
+  // rest of the 32 MiB queues natively, past the 16 MiB limit.
+  let closed = false;
+  const bridgeClose = new Promise(resolve => dc2.addEventListener('bridgeclose', event => {
+    closed = true;
+    resolve(event);
+  }));
+  const message = new Uint8Array(256 * 1024);
+  for (let i = 0; i < 128 && !closed && dc1.readyState === 'open'; i++) {
+    while (dc1.bufferedAmount > 1024 * 1024) {
+      await new Promise(resolve => setTimeout(resolve, 5));
+    }
+    dc1.send(message);
+  }
+  const { error } = await bridgeClose;
+  t.ok(error, 'the bridge closes with an error');
+
+  socket.destroy();
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('RTCDataChannel.bridgeTo(target) throws on invalid targets', t => {
+  const pc = new RTCPeerConnection();
+  const dc = pc.createDataChannel('foo');
+  t.throws(() => dc.bridgeTo('foo'), /TypeError/);
+  t.throws(() => dc.bridgeTo({ host: '127.0.0.1' }), /TypeError/);
+  pc.close();
+  t.end();
+});
@@ -0,0 +1,121 @@
+'use strict';
+
+const tape = require('tape');
+
+const { createConnectedDataChannels } = require('./lib/pc');
+
+function delay(ms) {
+  return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+[false, true].forEach(batchMessages => {
+  tape(`RTCDataChannel.createStream() pipes bytes from one RTCDataChannel to another (batchMessages: ${batchMessages})`, async t => {
+    const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+    dc2.batchMessages = batchMessages;
+    const writable = dc1.createStream({ highWaterMark: 65536, maxMessageSize: 16384 });
+    const readable = dc2.createStream({ highWaterMark: 16384 });
+
+    const input = Buffer.alloc(1024 * 1024);
+    input.forEach((x, i) => { input[i] = i % 251; });
+
+    const chunks = [];
+    const endPromise = new Promise(resolve => {
+      readable.on('data', chunk => chunks.push(chunk));
+      readable.on('end', resolve);
+    });
+    writable.end(input);
+    await endPromise;
+
+    t.ok(Buffer.concat(chunks).equals(input), 'every byte is received in order');
+    pc1.close();
+    pc2.close();
+    t.end();
+  });
+});
+
+tape('RTCDataChannel.createStream() pauses the RTCDataChannel while the stream is not read', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  const readable = dc2.createStream({ highWaterMark: 4096 });
+  let delivered = 0;
+  dc2.addEventListener('message', () => delivered++);
+
+  const n = 64;
+  const size = 1024;
+  for (let i = 0; i < n; i++) {
+    dc1.send(new Uint8Array(size));
+  }
+  while (dc2.getNativeStats().messagesReceived < n) {
+    await delay(10);
+  }
+  await delay(50);
+  t.ok(delivered < n, `only ${delivered} of ${n} messages are delivered while the stream is full`);
+
+  let bytes = 0;
+  readable.on('data', chunk => { bytes += chunk.length; });
+  while (bytes < n * size) {
+    await delay(10);
+  }
+  t.equal(bytes, n * size, 'the rest are delivered once the stream is read');
+
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('RTCDataChannel.createStream() completes writes only once bufferedAmount falls to highWaterMark', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  dc1.bufferedAmountLowThreshold = 123;
+  const highWaterMark = 16384;
+  const writable = dc1.createStream({ highWaterMark, maxMessageSize: 4096 });
+  t.equal(dc1.bufferedAmountLowThreshold, highWaterMark / 2, 'the stream sets bufferedAmountLowThreshold');
+
+  let received = 0;
+  dc2.onmessage = ({ data }) => { received += data.byteLength; };
+  const closePromise = new Promise(resolve => { dc2.onclose = resolve; });
+
+  const chunk = Buffer.alloc(256 * 1024);
+  const n = 8;
+  for (let i = 0; i < n; i++) {
+    await new Promise((resolve, reject) => writable.write(chunk, error => {
+      if (error) {
+        reject(error);
+        return;
+      }
+      t.ok(dc1.bufferedAmount <= highWaterMark, `write ${i} completes with bufferedAmount ${dc1.bufferedAmount}`);
+      resolve();
+    }));
+  }
+  await new Promise(resolve => writable.end(resolve));
+  await closePromise;
+  t.equal(dc1.bufferedAmountLowThreshold, 123, 'closing the stream restores bufferedAmountLowThreshold');
+  t.equal(received, n * chunk.length, 'every byte is received');
+
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('RTCDataChannel.createStream() fails the stream if too many messages arrive while it is not read', async t => {
+  const { pc1, pc2, dc1, dc2 } = await createConnectedDataChannels();
+  const readable = dc2.createStream({ highWaterMark: 1024 });
+  const errorPromise = new Promise(resolve => readable.once('error', resolve));
+
+  // NOTE: 64 messages of 256 KiB fill the 16 MiB held while paused.
+  const message = new Uint8Array(256 * 1024);
+  for (let i = 0; i < 72 && dc1.readyState === 'open'; i++) {
+    while (dc1.bufferedAmount > 1024 * 1024) {
+      await delay(5);
+    }
+    if (dc1.readyState === 'open') {
+      dc1.send(message);
+    }
+  }
+
+  const error = await errorPromise;
+  t.ok(error instanceof Error, 'the stream emits "error" instead of losing messages');
+  t.ok(readable.destroyed, 'the stream is destroyed');
+
+  pc1.close();
+  pc2.close();
+  t.end();
+});
@@ -23,3 +23,257 @@ test('RTCVideoSink', t => {
     t.end();
   });
 });
+
+test('RTCVideoSink with zeroCopy reports each plane\'s offset and stride', async t => {
+  const source = new RTCVideoSource();
+  const track = source.createTrack();
+  const sink = new RTCVideoSink(track, { zeroCopy: true });
+  const inputFrame = new I420Frame(160, 120);
+  inputFrame.data.forEach((_, i) => { inputFrame.data[i] = i % 251; });
+  const outputFramePromise = new Promise(resolve => { sink.onframe = ({ frame }) => resolve(frame); });
+  source.onFrame(inputFrame);
+  const outputFrame = await outputFramePromise;
+
+  t.equal(outputFrame.width, inputFrame.width);
+  t.equal(outputFrame.height, inputFrame.height);
+  t.equal(outputFrame.planes.length, 3);
+  const packed = [];
+  outputFrame.planes.forEach(({ offset, stride }, i) => {
+    const width = i ? inputFrame.width / 2 : inputFrame.width;
+    const height = i ? inputFrame.height / 2 : inputFrame.height;
+    for (let y = 0; y < height; y++) {
+      const row = outputFrame.data.subarray(offset + y * stride, offset + y * stride + width);
+      packed.push(...row);
+    }
+  });
+  t.deepEqual(packed, Array.from(inputFrame.data), 'the planes match the input frame');
+
+  sink.stop();
+  track.stop();
+  t.end();
+});
+
+test('RTCVideoSink with zeroCopy never lets JavaScript write into another sink\'s frame', async t => {
+  const source = new RTCVideoSource();
+  const track = source.createTrack();
+  const writer = new RTCVideoSink(track, { zeroCopy: true });
+  const reader = new RTCVideoSink(track, { zeroCopy: true });
+  const inputFrame = new I420Frame(160, 120);
+  inputFrame.data.forEach((_, i) => { inputFrame.data[i] = i % 251; });
+
+  // NOTE: Both sinks receive the same libwebrtc buffer; the first to run
+  // scribbles over its frame before the other looks at its own.
+  const framesPromise = new Promise(resolve => {
+    const frames = [];
+    const onframe = ({ frame }) => {
+      frames.push(Array.from(frame.data));
+      frame.data.fill(0);
+      if (frames.length === 2) {
+        resolve(frames);
+      }
+    };
+    writer.onframe = onframe;
+    reader.onframe = onframe;
+  });
+  source.onFrame(inputFrame);
+  const frames = await framesPromise;
+  t.deepEqual(frames[0], Array.from(inputFrame.data), 'the first sink sees the input frame');
+  t.deepEqual(frames[1], Array.from(inputFrame.data), 'the second sink is unaffected by writes from the first');
+
+  writer.stop();
+  reader.stop();
+  track.stop();
+  t.end();
+});
+
+test('RTCVideoSink scales and converts frames natively', async t => {
+  const source = new RTCVideoSource();
+  const track = source.createTrack();
+  const rgbaSink = new RTCVideoSink(track, { format: 'rgba', width: 80, height: 60 });
+  const nv12Sink = new RTCVideoSink(track, { format: 'nv12', width: 80 });
+  const i420Sink = new RTCVideoSink(track, { height: 30 });
+  const sinks = [rgbaSink, nv12Sink, i420Sink];
+  const framesPromise = Promise.all(sinks.map(sink => new Promise(resolve => {
+    sink.onframe = ({ frame }) => resolve(frame);
+  })));
+  source.onFrame(new I420Frame(160, 120));
+  const [rgbaFrame, nv12Frame, i420Frame] = await framesPromise;
+
+  t.equal(rgbaFrame.width, 80);
+  t.equal(rgbaFrame.height, 60);
+  t.equal(rgbaFrame.data.byteLength, 80 * 60 * 4);
+  t.deepEqual(rgbaFrame.planes, [{ offset: 0, stride: 80 * 4 }]);
+
+  t.equal(nv12Frame.height, 60, 'height follows the aspect ratio');
+  t.equal(nv12Frame.data.byteLength, 80 * 60 * 1.5);
+  t.deepEqual(nv12Frame.planes, [{ offset: 0, stride: 80 }, { offset: 80 * 60, stride: 80 }]);
+
+  t.equal(i420Frame.width, 40, 'width follows the aspect ratio');
+  t.equal(i420Frame.data.byteLength, 40 * 30 * 1.5);
+
+  sinks.forEach(sink => sink.stop());
+  track.stop();
+  t.end();
+});
+
+test('RTCVideoSink rejects invalid formats and sizes', t => {
+  const source = new RTCVideoSource();
+  const track = source.createTrack();
+  t.throws(() => new RTCVideoSink(track, { format: 'foo' }), TypeError);
+  t.throws(() => new RTCVideoSink(track, { width: 0 }), TypeError);
+  t.throws(() => new RTCVideoSink(track, { height: 20000 }), TypeError);
+  track.stop();
+  t.end();
+});
+
+test('RTCVideoSink\'s wants adapt a local RTCVideoSource created with adaptFrames', async t => {
+  const source = new RTCVideoSource({ adaptFrames: true });
+  t.equal(source.adaptFrames, true);
+  const track = source.createTrack();
+  const maxPixelCount = 160 * 120 / 4;
+  const sink = new RTCVideoSink(track, { maxPixelCount });
+  const nextFrame = () => new Promise(resolve => {
+    sink.onframe = ({ frame }) => resolve(frame);
+    source.onFrame(new I420Frame(160, 120));
+  });
+
+  const smallFrame = await nextFrame();
+  t.ok(smallFrame.width * smallFrame.height <= maxPixelCount, 'frames are scaled down to maxPixelCount');
+
+  sink.updateWants({});
+  const fullFrame = await nextFrame();
+  t.equal(fullFrame.width, 160, 'updateWants lifts the limit');
+  t.equal(fullFrame.height, 120);
+
+  t.throws(() => sink.updateWants({ resolutionAlignment: 0 }), TypeError);
+  t.throws(() => sink.updateWants({ maxPixelCount: 100, targetPixelCount: 200 }), TypeError);
+  t.throws(() => new RTCVideoSink(track, { maxFramerate: -1 }), TypeError);
+
+  sink.stop();
+  t.throws(() => sink.updateWants({}), /InvalidStateError|RTCVideoSink is stopped/);
+  track.stop();
+  t.end();
+});
+
+test('RTCVideoSink\'s wants do not change frames from an RTCVideoSource by default', async t => {
+  const source = new RTCVideoSource();
+  t.equal(source.adaptFrames, false);
+  const track = source.createTrack();
+  const sink = new RTCVideoSink(track, { maxPixelCount: 160 * 120 / 4, maxFramerate: 1 });
+  const received = [];
+  sink.onframe = ({ frame }) => received.push(frame);
+  const n = 5;
+  for (let i = 0; i < n; i++) {
+    source.onFrame(new I420Frame(160, 120));
+  }
+  await new Promise(resolve => setTimeout(resolve, 100));
+  t.equal(received.length, n, 'no frames are dropped');
+  t.ok(received.every(frame => frame.width === 160 && frame.height === 120), 'no frames are scaled');
+  sink.stop();
+  track.stop();
+  t.end();
+});
+
+test('RTCVideoSink with latestFrameOnly delivers only the newest frame', async t => {
+  const source = new RTCVideoSource();
+  const track = source.createTrack();
+  const sink = new RTCVideoSink(track, { latestFrameOnly: true });
+  const received = [];
+  sink.onframe = ({ frame }) => received.push(frame.data[0]);
+  const n = 5;
+  for (let i = 0; i < n; i++) {
+    const frame = new I420Frame(160, 120);
+    frame.data[0] = i;
+    source.onFrame(frame);
+  }
+  await new Promise(resolve => setTimeout(resolve, 100));
+  t.deepEqual(received, [n - 1], 'only the newest frame is delivered');
+  t.equal(sink.droppedEvents, n - 1, 'older frames are dropped and counted');
+  sink.stop();
+  track.stop();
+  t.end();
+});
+
+test('RTCVideoSink with maxFramesPerSecond skips frames natively', async t => {
+  const source = new RTCVideoSource();
+  const track = source.createTrack();
+  t.throws(() => new RTCVideoSink(track, { maxFramesPerSecond: 0 }), TypeError);
+  t.throws(() => new RTCVideoSink(track, { maxFramesPerSecond: -1 }), TypeError);
+  const sink = new RTCVideoSink(track, { maxFramesPerSecond: 1 });
+  let received = 0;
+  sink.onframe = () => received++;
+  const slowest = new RTCVideoSink(track, { maxFramesPerSecond: Number.MIN_VALUE });
+  let receivedSlowest = 0;
+  slowest.onframe = () => receivedSlowest++;
+  const n = 5;
+  for (let i = 0; i < n; i++) {
+    source.onFrame(new I420Frame(160, 120));
+  }
+  await new Promise(resolve => setTimeout(resolve, 100));
+  t.equal(received, 1, 'frames over the limit are not delivered');
+  t.equal(sink.skippedFrames, n - 1, 'skipped frames are counted');
+  t.equal(sink.droppedEvents, 0, 'skipped frames are never queued');
+  t.equal(receivedSlowest, 1, 'a vanishingly small limit still delivers the first frame');
+  t.equal(slowest.skippedFrames, n - 1, 'and skips the rest');
+  sink.stop();
+  slowest.stop();
+  track.stop();
+  t.end();
+});
+
+test('RTCVideoSink\'s readLatestFrame copies, scales and converts the latest frame on demand', async t => {
+  const source = new RTCVideoSource();
+  const track = source.createTrack();
+  const sink = new RTCVideoSink(track, { dispatchFrames: false });
+  let dispatched = 0;
+  sink.onframe = () => dispatched++;
+
+  const target = new I420Frame(160, 120);
+  t.equal(sink.readLatestFrame(target), null, 'there is no frame yet');
+
+  const inputFrame = new I420Frame(160, 120);
+  inputFrame.data.forEach((_, i) => { inputFrame.data[i] = i % 251; });
+  source.onFrame(inputFrame);
+
+  const info = sink.readLatestFrame(target);
+  t.equal(info.width, 160);
+  t.equal(info.height, 120);
+  t.equal(typeof info.timestamp, 'number');
+  t.deepEqual(target.data, inputFrame.data, 'the latest frame is copied into the target');
+
+  const rgba = { width: 80, height: 60, format: 'rgba', data: new Uint8Array(80 * 60 * 4) };
+  t.ok(sink.readLatestFrame(rgba), 'the latest frame can be scaled and converted');
+  t.throws(() => sink.readLatestFrame({ width: 80, height: 60, data: new Uint8Array(1) }), TypeError);
+  t.throws(() => sink.readLatestFrame({ width: 80, height: 60, format: 'foo', data: rgba.data }), TypeError);
+
+  await new Promise(resolve => setTimeout(resolve, 100));
+  t.equal(dispatched, 0, 'no "frame" events are dispatched');
+
+  sink.stop();
+  t.equal(sink.readLatestFrame(target), null, 'a stopped RTCVideoSink releases its frame');
+  track.stop();
+  t.end();
+});
+
+test('RTCVideoSink only holds onto the latest frame once readLatestFrame is called', async t => {
+  const source = new RTCVideoSource();
+  const track = source.createTrack();
+  const sink = new RTCVideoSink(track);
+  let dispatched = 0;
+  sink.onframe = () => dispatched++;
+  const target = new I420Frame(160, 120);
+
+  source.onFrame(new I420Frame(160, 120));
+  await new Promise(resolve => setTimeout(resolve, 100));
+  t.equal(dispatched, 1);
+  t.equal(sink.readLatestFrame(target), null, 'frames before the first call are not held');
+
+  source.onFrame(new I420Frame(160, 120));
+  await new Promise(resolve => setTimeout(resolve, 100));
+  t.equal(dispatched, 2);
+  t.ok(sink.readLatestFrame(target), 'frames after the first call are held');
+
+  sink.stop();
+  track.stop();
+  t.end();
+});
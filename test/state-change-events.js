@@ -0,0 +1,53 @@
+'use strict';
+
+const tape = require('tape');
+const { RTCPeerConnection } = require('..');
+const { negotiateRTCPeerConnections, waitForStateChange } = require('./lib/pc');
+
+const stateAttributes = {
+  connectionstatechange: 'connectionState',
+  iceconnectionstatechange: 'iceConnectionState',
+  icegatheringstatechange: 'iceGatheringState',
+  signalingstatechange: 'signalingState'
+};
+
+function recordStateChanges(pc) {
+  return Object.keys(stateAttributes).reduce((changes, type) => {
+    changes[type] = [];
+    pc.addEventListener(type, () => changes[type].push(pc[stateAttributes[type]]));
+    return changes;
+  }, {});
+}
+
+tape('State change events are coalesced, but never skipped', async t => {
+  let changes;
+  const [pc1, pc2] = await negotiateRTCPeerConnections({
+    withPc1(pc1) {
+      pc1.createDataChannel('foo');
+      changes = recordStateChanges(pc1);
+    }
+  });
+  await waitForStateChange(pc1, 'connected', { event: 'connectionstatechange', property: 'connectionState' });
+
+  // NOTE: pc1 went from "stable" to "have-local-offer" and back, so
+  // even if both changes were coalesced, "signalingstatechange" fired.
+  t.ok(changes.signalingstatechange.length >= 1, '"signalingstatechange" fires even if the state changed back');
+  t.ok(changes.icegatheringstatechange.length >= 1, '"icegatheringstatechange" fires');
+  t.equal(changes.signalingstatechange[changes.signalingstatechange.length - 1], 'stable');
+  t.equal(changes.connectionstatechange[changes.connectionstatechange.length - 1], 'connected');
+
+  pc1.close();
+  pc2.close();
+  t.end();
+});
+
+tape('State getters return the current state, even before its event fires', async t => {
+  const pc = new RTCPeerConnection();
+  pc.createDataChannel('foo');
+  const offer = await pc.createOffer();
+  await pc.setLocalDescription(offer);
+  t.equal(pc.signalingState, 'have-local-offer');
+  pc.close();
+  t.equal(pc.signalingState, 'closed');
+  t.end();
+});